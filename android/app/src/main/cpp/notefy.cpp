@@ -14,6 +14,16 @@
 #include <math.h>
 #include <float.h>
 #include <string.h>
+#include <pthread.h>
+#ifdef __APPLE__
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#endif
+#include <sys/mman.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
 
 // ============================================================================
 // YIN Algorithm Configuration
@@ -49,416 +59,3226 @@
 #define NOISE_GATE_ATTACK_FRAMES 2  // Frames needed to "open" gate
 #define NOISE_GATE_RELEASE_FRAMES 5 // Frames before gate "closes"
 
+// All *_FRAMES timings are measured in audio time, in units of this many
+// samples, so they mean the same with whole 8192-sample frames and with the
+// overlapping windows of the streaming API
+#define REFERENCE_FRAME_SAMPLES 8192
+
+// ============================================================================
+// Onset Detection Configuration
+// ============================================================================
+
+// Energy onsets are found at sub-frame resolution. A genuine attack opens the
+// gate at once (no NOISE_GATE_ATTACK_FRAMES wait), drops stale tracking state
+// and restricts analysis to the samples after the pluck transient.
+#define ONSET_BLOCK_SIZE 256        // Sub-frame energy resolution (~6 ms)
+#define ONSET_ENERGY_RATIO 4.0f     // Jump over running energy (~6 dB) = attack
+#define ONSET_ENERGY_DECAY 0.9f     // Running energy average per block
+#define ONSET_SKIP_SAMPLES 1024     // Transient skipped after the attack (~23 ms)
+#define ONSET_REFRACTORY_BLOCKS 16  // Blocks ignored after an onset (~93 ms)
+
+// ============================================================================
+// Idle Mode Configuration
+// ============================================================================
+
+// After the gate has been closed this long the engine drops into a low-power
+// idle mode: only every IDLE_FRAME_INTERVAL-th frame is examined, and only
+// every IDLE_DECIMATION-th sample of it. Energy above the wake threshold
+// brings full analysis back on the same frame.
+#define IDLE_ENTER_FRAMES 16     // ~3 s of silence at 8192 samples/frame
+#define IDLE_FRAME_INTERVAL 2    // Examine one frame out of N while idle
+#define IDLE_DECIMATION 8        // Sample stride of the idle energy probe
+#define IDLE_WAKE_RATIO 0.5f     // Fraction of the gate threshold that wakes us
+
+// ============================================================================
+// Mains Hum Rejection Configuration
+// ============================================================================
+
+// Hum is detected as a tonal 50 Hz or 60 Hz harmonic family, then removed
+// by an IIR comb notch running ahead of YIN:
+//   H(z) = (1 - z^-D) / (1 - rho * z^-D),  D = fs / f0
+// Passband gain is 2 / (1 + rho), close enough to unity to leave unscaled.
+#define HUM_NOMINAL_50 50.0f
+#define HUM_NOMINAL_60 60.0f
+#define HUM_HARMONICS 3            // Harmonics scored per family
+#define HUM_DETECT_INTERVAL 4      // Frames between detection passes
+#define HUM_DETECT_DECIMATION 4    // Sample stride of the detection Goertzels
+#define HUM_NEIGHBOR_OFFSET 8.0f   // Hz offset of the reference bins
+#define HUM_PEAK_RATIO 4.0f        // Hum bin power vs. neighbour bins
+#define HUM_MIN_LEVEL 0.002f       // Min hum amplitude (RMS) worth removing
+#define HUM_CONFIRM_DETECTIONS 2   // Consecutive hits before the notch engages
+#define HUM_RELEASE_DETECTIONS 4   // Missed detections before the notch drops
+#define HUM_TRACK_SPAN 1.0f        // Hz spacing of the frequency fit probes
+#define HUM_TRACK_SMOOTHING 0.3f   // Exponential smoothing of drift estimates
+#define HUM_MAX_DRIFT 0.5f         // Max tracked deviation from nominal (Hz)
+#define HUM_COMB_POLE 0.97f        // Notch width (closer to 1 = narrower)
+
+// ============================================================================
+// Spectral Subtraction Denoiser Configuration
+// ============================================================================
+
+// Optional STFT stage: learns the noise magnitude spectrum while the gate is
+// closed and subtracts it from voiced frames before YIN.
+// sqrt-Hann analysis/synthesis windows at 50% overlap reconstruct exactly.
+#define SS_FFT_SIZE 1024             // STFT frame (power of two)
+#define SS_HOP_SIZE (SS_FFT_SIZE / 2) // 50% overlap
+#define SS_LEARN_FRAMES_PER_BLOCK 4  // STFT frames sampled per closed-gate block
+#define SS_LEARN_WARMUP 16           // Plain average until this many frames
+#define SS_LEARN_RATE 0.05f          // Exponential update after warm-up
+#define SS_MIN_LEARN_FRAMES 4        // Frames needed before subtracting
+#define SS_OVERSUBTRACTION 2.0f      // Noise magnitude multiplier
+#define SS_SPECTRAL_FLOOR 0.05f      // Min fraction of original magnitude kept
+
+// ============================================================================
+// Pitch Smoothing Configuration
+// ============================================================================
+
+// Raw YIN estimates (in absolute cents) that stray too far from the median of
+// the last few are replaced by that median, which drops octave slips without
+// adding lag to a moving pitch. Then a constant-velocity Kalman filter
+// whose measurement noise grows as YIN confidence falls. The filter state is
+// [cents, cents/second], so the drift rate comes for free.
+#define SMOOTH_MEDIAN_SIZE 5            // Outlier-rejecting median (odd)
+#define SMOOTH_OUTLIER_CENTS 30.0f      // Distance from the median that marks an outlier
+#define SMOOTH_ACCELERATION_NOISE 2000.0f // Process noise, cents^2/s^4
+#define SMOOTH_MEASUREMENT_NOISE 1.0f   // Measurement variance at full confidence (cents^2)
+#define SMOOTH_CONFIDENCE_WEIGHT 20.0f  // Variance scale per unit of (1 - confidence)
+#define SMOOTH_RESET_CENTS 50.0f        // Innovation this large = new note, restart
+#define SMOOTH_MAX_GAP_SECONDS 0.5f     // Longer gaps between estimates restart
+
+// ============================================================================
+// Streaming Configuration
+// ============================================================================
+
+// tuner_push() accepts blocks of any size. The engine keeps the most recent
+// analysis window in a ring and emits an estimate every hop, so the update
+// rate no longer depends on the capture buffer size.
+#define STREAM_DEFAULT_WINDOW 8192 // Analysis window (samples)
+#define STREAM_DEFAULT_HOP 2048    // Samples between estimates (~46 ms)
+#define STREAM_MIN_WINDOW 256
+#define STREAM_MAX_WINDOW 65536
+
+// Capture ring between the audio callback (producer) and the analysis
+// thread (consumer). Capacity is rounded up to a power of two.
+#define CAPTURE_RING_DEFAULT_CAPACITY 32768 // ~0.74 s at 44.1 kHz
+#define CAPTURE_RING_MAX_CAPACITY (1 << 22)
+#define CAPTURE_STAMP_COUNT 256 // Arrival times kept for unread blocks (power of two)
+
+// Engine-owned input buffer that Dart fills through a Float32List view
+#define INPUT_BUFFER_MAX_CAPACITY (1 << 20)
+
+// ============================================================================
+// CPU Budget Governor Configuration
+// ============================================================================
+
+// Each analysis is timed against a budget: the fraction of the audio time it
+// covers that analysis may spend. Over budget, the quality level steps down
+// (see GOVERNOR_LEVELS); with enough headroom it steps back up.
+#define GOVERNOR_DEFAULT_BUDGET 0.5f // Fraction of real time (0 = governor off)
+#define GOVERNOR_LOAD_SMOOTHING 0.25f // EMA weight of each new load sample
+#define GOVERNOR_STEP_DOWN_COUNT 2    // Consecutive analyses over budget
+#define GOVERNOR_STEP_UP_COUNT 16     // Consecutive analyses with headroom
+#define GOVERNOR_HEADROOM 0.6f        // Predicted load must be below budget * this
+#define GOVERNOR_MIN_RATE_RATIO 2.2f  // Decimated rate vs. max frequency
+
+// ============================================================================
+// Trail History Configuration
+// ============================================================================
+
+// Each estimate appends the offset the UI shows (cents) to a fixed ring that
+// the seismograph draws from directly. Capacity must be a power of two.
+#define TRAIL_CAPACITY 4096
+#define TRAIL_CENTS_LIMIT 100.0f  // Offsets from a reference pitch are clamped
+#define TRAIL_PITCH_MIN 20.0f     // Smoothed pitch outside this range is silence
+#define TRAIL_PITCH_MAX 5000.0f
+#define TRAIL_ENTRY_RATE 60       // Entries per second of audio (one per UI frame)
+
+// ============================================================================
+// Scratch Memory Configuration
+// ============================================================================
+
+// All scratch buffers are cache-line aligned (also covers 16/32-byte SIMD)
+#define SCRATCH_ALIGNMENT 64
+
+// ============================================================================
+// Result Structure (shared with Dart, keep field order in sync)
+// ============================================================================
+typedef struct
+{
+    float pitchHz;             // Raw YIN estimate (-1 if none)
+    float confidence;          // YIN confidence 0..1 (0 if none)
+    float smoothedPitchHz;     // Median + Kalman estimate (-1 if none)
+    float driftCentsPerSecond; // Rate of change of the smoothed pitch
+} TunerResult;
+
+// Where an estimate's time went, in seconds on the engine's monotonic clock
+// (tuner_now). audioTime is when the middle of the analysed window was
+// captured, taken to be when its block arrived minus the audio after it.
+typedef struct
+{
+    double audioTime;     // Capture time of the window centre
+    double blockArrival;  // When the block holding the newest sample arrived
+    double analysisStart;
+    double analysisEnd;
+} TunerTiming;
+
+// Latest estimate plus engine state, published under a sequence counter
+// (seqlock) so the UI can read it in place at vsync without an FFI call.
+// Readers retry while the sequence is odd or changes across the read; the
+// writer never waits. Fits two cache lines.
+typedef struct alignas(64)
+{
+    uint32_t sequence; // Odd while a write is in progress
+    uint32_t count;    // Estimates published so far
+    float pitchHz;
+    float confidence;
+    float smoothedPitchHz;
+    float driftCentsPerSecond;
+    float humFrequency; // 0 if no hum is being rejected
+    uint32_t gateOpen;
+    uint32_t idle;
+    uint32_t qualityLevel; // Governor level, 0 = full quality
+    TunerTiming timing;
+} TunerSharedResult;
+
+// Real-time audit counters (shared with Dart, keep field order in sync).
+// Only an audit build (NOTEFY_RT_AUDIT) fills these in.
+typedef struct
+{
+    uint32_t frames;      // Frames processed since the last reset
+    uint32_t allocations; // malloc/calloc/realloc/posix_memalign inside a frame
+    uint32_t frees;       // free inside a frame
+    uint32_t locks;       // pthread_mutex_lock inside a frame
+} TunerRtAudit;
+
+// Displayed-cents history (shared with Dart, keep field order in sync).
+// Entry i is cents[i % capacity]; head counts entries written and is stored
+// after its entry, so everything below head is complete. It only grows.
+// Entries are TRAIL_ENTRY_RATE per second of audio; silence is NAN.
+typedef struct
+{
+    uint32_t head;
+    uint32_t capacity;
+    float cents[TRAIL_CAPACITY];
+} TunerTrail;
+
+// Immutable configuration snapshot. Setters edit a pending copy and publish
+// it whole; the processing side adopts it at the next frame boundary.
+typedef struct
+{
+    int mode;
+    float minFrequency;
+    float maxFrequency;
+    float noiseThreshold;
+    bool humRejection;
+    bool denoiser;
+    float cpuBudget;
+    float trailReference; // Pitch the trail is relative to (0 = nearest note)
+} TunerConfig;
+
+#define CONFIG_SLOT_MASK 3 // Triple buffer slot index bits
+#define CONFIG_DIRTY 4     // Set on the middle slot when unread
+
+// One rung of the governor's quality ladder
+typedef struct
+{
+    int decimation; // YIN input downsampling factor (power of two)
+    int hopStride;  // Analyze one hop (or frame) out of this many
+} GovernorLevel;
+
+// Called on the analysis thread with each new estimate. Dart registers a
+// NativeCallable.listener here, which queues the call onto its isolate.
+typedef void (*TunerResultCallback)(float pitchHz, float confidence,
+                                    float smoothedPitchHz, float driftCentsPerSecond);
+
+// ============================================================================
+// Versioned API Table (shared with Dart, keep field order in sync)
+// ============================================================================
+
+// Layout version served by tuner_get_api. Entries are only ever appended, so
+// a table of version N also serves every caller that asks for N or lower.
+#define TUNER_API_VERSION 4
+
+// Capability bits: which parts of the table do real work in this build
+#define TUNER_CAP_SMOOTHING (1u << 0)       // detect_pitch_smoothed
+#define TUNER_CAP_STREAM (1u << 1)          // tuner_stream_configure/push/poll
+#define TUNER_CAP_ANALYSIS_THREAD (1u << 2) // Capture ring + worker + callback
+#define TUNER_CAP_SHARED_RESULT (1u << 3)   // Seqlock result block
+#define TUNER_CAP_GOVERNOR (1u << 4)        // CPU budget / quality levels
+#define TUNER_CAP_DENOISER (1u << 5)        // Hum comb + spectral denoiser
+#define TUNER_CAP_RT_AUDIT (1u << 6)        // Audit build (NOTEFY_RT_AUDIT)
+
+// Every entry point behind one symbol, so a binding needs a single lookup
+typedef struct
+{
+    uint32_t version;      // Layout version of this table
+    uint32_t capabilities; // TUNER_CAP_* bits
+
+    // Version 1
+    float (*detectPitch)(float *audioData, int length, int sampleRate);
+    float (*detectPitchWithConfidence)(float *audioData, int length, int sampleRate, float *outConfidence);
+    float (*detectPitchSmoothed)(float *audioData, int length, int sampleRate, TunerResult *outResult);
+    void (*cleanup)();
+    void (*setTuningMode)(int mode);
+    void (*setNoiseThreshold)(float threshold);
+    void (*setFrequencyRange)(float minFreq, float maxFreq);
+    void (*resetFrequencyRange)();
+    bool (*isGateOpen)();
+    bool (*isIdle)();
+    void (*setHumRejection)(bool enabled);
+    float (*getHumFrequency)();
+    void (*setSpectralDenoiser)(bool enabled);
+    float *(*inputBuffer)(int capacity);
+    bool (*prepare)(int maxLength, int sampleRate, bool lockMemory);
+    bool (*isMemoryLocked)();
+    size_t (*memoryFootprint)();
+    void (*setCpuBudget)(float budget);
+    int (*qualityLevel)();
+    float (*cpuLoad)();
+    bool (*rtAudit)(TunerRtAudit *outAudit);
+    void (*rtAuditReset)(bool trap);
+    bool (*streamConfigure)(int windowSize, int hopSize, int sampleRate);
+    int (*streamPush)(const float *samples, int n);
+    bool (*streamPoll)(TunerResult *outResult);
+    const TunerSharedResult *(*sharedResult)();
+    bool (*analysisStart)(int capacity);
+    void (*analysisStop)();
+    int (*captureWrite)(const float *samples, int n);
+    int (*captureWriteF64)(const double *samples, int n);
+    uint32_t (*captureOverruns)();
+    void (*setResultCallback)(TunerResultCallback callback);
+
+    // Version 2
+    const TunerTrail *(*trail)();
+    void (*setTrailReference)(float referenceHz);
+
+    // Version 3
+    double (*now)();
+
+    // Version 4
+    float *(*inputBufferAlloc)(int capacity);
+    void (*inputBufferFree)(float *buffer);
+} TunerApi;
+
+// ============================================================================
+// Capture signal: the capture callback wakes the analysis thread through a
+// counting semaphore, which posts without locking. Apple platforms do not
+// implement unnamed POSIX semaphores (sem_init fails with ENOSYS), so they
+// use a dispatch semaphore instead.
+// ============================================================================
+#ifdef __APPLE__
+typedef dispatch_semaphore_t CaptureSignal;
+
+static inline bool capture_signal_init(CaptureSignal *signal)
+{
+    *signal = dispatch_semaphore_create(0);
+    return *signal != nullptr;
+}
+
+static inline void capture_signal_post(CaptureSignal *signal)
+{
+    dispatch_semaphore_signal(*signal);
+}
+
+static inline void capture_signal_wait(CaptureSignal *signal)
+{
+    dispatch_semaphore_wait(*signal, DISPATCH_TIME_FOREVER);
+}
+
+static inline void capture_signal_destroy(CaptureSignal *signal)
+{
+    dispatch_release(*signal);
+    *signal = nullptr;
+}
+#else
+typedef sem_t CaptureSignal;
+
+static inline bool capture_signal_init(CaptureSignal *signal)
+{
+    return sem_init(signal, 0, 0) == 0;
+}
+
+static inline void capture_signal_post(CaptureSignal *signal)
+{
+    sem_post(signal);
+}
+
+// Returns early on a signal; callers re-check their condition anyway
+static inline void capture_signal_wait(CaptureSignal *signal)
+{
+    sem_wait(signal);
+}
+
+static inline void capture_signal_destroy(CaptureSignal *signal)
+{
+    sem_destroy(signal);
+}
+#endif
+
 // ============================================================================
-// Static buffers for reuse (avoids malloc/free overhead in real-time)
+// Scratch arena: one aligned block per engine, carved into every stage buffer
 // ============================================================================
-static float *g_yinBuffer = nullptr;
-static int g_yinBufferSize = 0;
+static uint8_t *g_arenaBase = nullptr;
+static size_t g_arenaSize = 0;        // Exact footprint (bytes)
+static size_t g_arenaSessionEnd = 0;  // Buffers below this persist across frames
+static size_t g_arenaUsed = 0;        // Bump offset; back to session end per frame
+static int g_arenaMaxLength = 0;      // Largest frame the layout covers
+static int g_arenaSampleRate = 0;     // Rate the hum history was sized for
+
+// Preallocation (tuner_prepare): once set, the arena is never re-created
+static bool g_prepared = false;
+static bool g_memoryLocked = false;   // Arena is mlock()ed
 
 // Noise gate state
-static int g_gateOpenCounter = 0;      // Counts frames above threshold
-static int g_gateCloseCounter = 0;     // Counts frames below threshold
+static int g_gateOpenSamples = 0;      // Audio above threshold (samples)
+static int g_gateCloseSamples = 0;     // Audio below threshold (samples)
 static bool g_gateIsOpen = false;      // Current gate state
 static float g_lastValidPitch = -1.0f; // Last detected pitch for stability
 
-// Current mode settings
+// Onset detector state (carries across frames)
+static float g_onsetEnergyAverage = 0.0f; // Running mean-square per block
+static int g_onsetRefractory = 0;         // Blocks left before next onset
+static int g_samplesSinceOnset = -1;      // Audio since the last attack (-1 = none pending)
+static float g_onsetBlockSum = 0.0f;      // Energy of the block still being filled
+static int g_onsetBlockFill = 0;          // Samples in it; blocks span calls
+
+// Pitch smoothing state
+static float g_smoothHistory[SMOOTH_MEDIAN_SIZE]; // Recent raw estimates (cents)
+static int g_smoothHistoryCount = 0;
+static int g_smoothHistoryIndex = 0;
+static bool g_smoothValid = false;     // Kalman filter initialized
+static float g_smoothCents = 0.0f;     // State: position (absolute cents)
+static float g_smoothVelocity = 0.0f;  // State: drift (cents/second)
+static float g_smoothP00 = 0.0f;       // State covariance
+static float g_smoothP01 = 0.0f;
+static float g_smoothP11 = 0.0f;
+static long g_smoothSamplesSinceUpdate = 0; // Audio elapsed since last update
+
+// Idle mode state
+static bool g_isIdle = false;      // True while in low-power idle mode
+static int g_idleSamples = 0;      // Audio since the last idle probe
+
+// Hum rejection state (comb history persists across frames)
+static bool g_humRejectionEnabled = true;
+static bool g_humActive = false;         // Comb notch currently running
+static float g_humNominal = 0.0f;        // 50 or 60 when hum is detected
+static float g_humFrequency = 0.0f;      // Tracked mains frequency
+static int g_humDetectSamples = 0;       // Audio left until the next detection pass
+static int g_humMissCounter = 0;         // Consecutive missed detections
+static int g_humHitCounter = 0;          // Consecutive hits while not active
+static int g_humHistory = 0;             // History samples kept ahead of a frame
+static float *g_humInput = nullptr;      // [history | frame] raw input (arena)
+static float *g_humOutput = nullptr;     // [history | frame] comb output (arena)
+
+// Spectral subtraction state (FFT plan built with the arena)
+static bool g_denoiserEnabled = false;
+static float *g_ssCos = nullptr;        // Twiddle factors, SS_FFT_SIZE / 2
+static float *g_ssSin = nullptr;
+static int *g_ssBitReverse = nullptr;   // Bit-reversal permutation
+static float *g_ssWindow = nullptr;     // sqrt-Hann window
+static float *g_ssRe = nullptr;         // FFT work area
+static float *g_ssIm = nullptr;
+static float *g_ssNoise = nullptr;      // Learned noise magnitude per bin
+static int g_ssLearnedFrames = 0;
+static int g_ssLearnSamples = 0;        // Closed-gate audio not yet learned from
+
+// Streaming state (rings hold exactly one analysis window)
+static float *g_streamRaw = nullptr;      // Raw input ring (hum detection, arena)
+static float *g_streamFiltered = nullptr; // Hum-filtered input ring (arena)
+static int g_streamWindow = 0;            // 0 until tuner_stream_configure
+static int g_streamHop = 0;
+static int g_streamSampleRate = 0;
+static int g_streamWritePos = 0;          // Next ring slot to write
+static int g_streamFilled = 0;            // Valid samples in the rings
+static int g_streamSinceHop = 0;          // Samples since the last hop boundary
+static int g_streamPending = 0;           // Samples not yet seen by analysis
+static double g_streamArrival = 0.0;      // When the block being pushed arrived
+static double g_streamEndTime = 0.0;      // Capture time of its last sample
+static TunerSharedResult g_sharedResult;  // Seqlock block mapped by the UI
+static std::atomic<uint32_t> g_pollCount(0); // Shared-block count last returned by tuner_poll
+static uint32_t g_callbackCount = 0;         // Last count delivered to the callback (worker only)
+
+// Shared input buffer (tuner_input_buffer, superseded by per-caller
+// tuner_input_buffer_alloc). Separate from the arena so that arena growth
+// never moves memory Dart holds a view of.
+static float *g_inputBuffer = nullptr;
+static int g_inputCapacity = 0;
+
+// Capture ring (wait-free SPSC). Indices run freely and wrap via the mask.
+static float *g_captureRing = nullptr;
+static uint32_t g_captureCapacity = 0;
+static uint32_t g_captureMask = 0;
+static std::atomic<uint32_t> g_captureWriteIndex(0); // Written by producer only
+static std::atomic<uint32_t> g_captureReadIndex(0);  // Written by consumer only
+static std::atomic<uint32_t> g_captureOverruns(0);   // Samples dropped on a full ring
+static CaptureSignal g_captureSignal;                // Posted after each write
+static std::atomic<int> g_captureWriters(0);         // Producer calls in flight
+
+// Arrival stamp per committed block: the write index it ends at and when.
+// The producer fills a slot before releasing the write index that covers it.
+typedef struct
+{
+    uint32_t end;
+    double time;
+} CaptureStamp;
+static CaptureStamp g_captureStamps[CAPTURE_STAMP_COUNT];
+static std::atomic<uint32_t> g_captureStampWrite(0); // Written by producer only
+static uint32_t g_captureStampRead = 0;              // Consumer only
+static std::atomic<bool> g_analysisRunning(false);
+static std::thread g_analysisThread;
+static std::atomic<TunerResultCallback> g_resultCallback(nullptr);
+
+// Engine state as of the last finished frame, for the getters. The gate,
+// idle and hum globals belong to whichever thread is processing; these
+// copies are what other threads may read.
+static std::atomic<bool> g_reportedGateOpen(false);
+static std::atomic<bool> g_reportedIdle(false);
+static std::atomic<float> g_reportedHumFrequency(0.0f);
+
+// CPU budget governor. Level and load are read from other threads.
+static const GovernorLevel GOVERNOR_LEVELS[] = {
+    {1, 1}, // Full quality
+    {2, 1}, // Half-rate YIN, about a quarter of the cost
+    {2, 2}, // ... analyzing every other hop
+    {2, 4}, // ... analyzing every fourth hop
+};
+#define GOVERNOR_LEVEL_COUNT (int)(sizeof(GOVERNOR_LEVELS) / sizeof(GOVERNOR_LEVELS[0]))
+static float g_cpuBudget = GOVERNOR_DEFAULT_BUDGET;
+static std::atomic<int> g_governorLevel(0);
+static std::atomic<float> g_governorLoad(0.0f); // Smoothed fraction of real time
+static std::atomic<float> g_governorSimulatedLoad(-1.0f); // Test hook: full-quality load (< 0 = measure)
+static int g_governorOverCount = 0;   // Consecutive analyses over budget
+static int g_governorUnderCount = 0;  // Consecutive analyses with headroom
+static int g_governorHopsSkipped = 0; // Hops (or frames) since the last analysis
+static int g_governorFrameSamples = 0; // Whole-frame audio since the last analysis
+static TunerResult g_governorLastResult = {-1.0f, 0.0f, -1.0f, 0.0f}; // Repeated on skipped frames
+
+// Trail history, written by whichever thread runs the analysis
+static TunerTrail g_trail = {0, TRAIL_CAPACITY, {0.0f}};
+static float g_trailReference = 0.0f; // Active snapshot of the reference pitch
+static float g_trailLast = NAN;       // Most recent entry (NAN = silence)
+static int64_t g_trailDue = 0;        // Audio toward the next entry, x TRAIL_ENTRY_RATE
+
+// Current mode settings (active snapshot; written only by config_apply)
 static int g_currentMode = MODE_CHROMATIC;
 static float g_minFrequency = DEFAULT_MIN_FREQ;
 static float g_maxFrequency = DEFAULT_MAX_FREQ;
 static float g_noiseThreshold = NOISE_GATE_CHROMATIC;
 
+// Configuration triple buffer: setters own the back slot, processing owns
+// the front slot, and they swap through the atomic middle index.
+static const TunerConfig CONFIG_DEFAULTS = {
+    MODE_CHROMATIC, DEFAULT_MIN_FREQ, DEFAULT_MAX_FREQ, NOISE_GATE_CHROMATIC, true, false,
+    GOVERNOR_DEFAULT_BUDGET, 0.0f};
+static TunerConfig g_configPending = CONFIG_DEFAULTS; // Setters' working copy
+static TunerConfig g_configSlots[3] = {CONFIG_DEFAULTS, CONFIG_DEFAULTS, CONFIG_DEFAULTS};
+static int g_configBack = 1;                          // Owned by setters
+static int g_configFront = 0;                         // Owned by processing
+static std::atomic<int> g_configMiddle(2);
+
+// ============================================================================
+// Real-Time Audit (opt-in build, see NOTEFY_RT_AUDIT in CMakeLists.txt)
+// ============================================================================
+// The linker routes this library's calls to malloc/free/pthread_mutex_lock
+// through the __wrap_ functions below. Any call made while a frame is being
+// processed on the calling thread is counted, or aborts when trapping is on.
+// Calls made inside other libraries (libc++, liblog) are not seen.
+#ifdef NOTEFY_RT_AUDIT
+static thread_local int t_rtFrameDepth = 0; // > 0 while this thread is in a frame
+static std::atomic<uint32_t> g_rtFrames(0);
+static std::atomic<uint32_t> g_rtAllocations(0);
+static std::atomic<uint32_t> g_rtFrees(0);
+static std::atomic<uint32_t> g_rtLocks(0);
+static std::atomic<bool> g_rtTrap(false);
+
+static void rt_audit_violation(std::atomic<uint32_t> &counter)
+{
+    counter.fetch_add(1, std::memory_order_relaxed);
+    if (g_rtTrap.load(std::memory_order_relaxed))
+    {
+        abort();
+    }
+}
+
+// Marks the enclosing scope as frame processing; nests
+struct RtAuditFrame
+{
+    RtAuditFrame()
+    {
+        if (t_rtFrameDepth++ == 0)
+        {
+            g_rtFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    ~RtAuditFrame() { t_rtFrameDepth--; }
+};
+#define RT_AUDIT_FRAME() RtAuditFrame rtAuditFrame
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *pointer, size_t size);
+    int __real_posix_memalign(void **pointer, size_t alignment, size_t size);
+    void __real_free(void *pointer);
+    int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+
+    void *__wrap_malloc(size_t size)
+    {
+        if (t_rtFrameDepth > 0)
+        {
+            rt_audit_violation(g_rtAllocations);
+        }
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        if (t_rtFrameDepth > 0)
+        {
+            rt_audit_violation(g_rtAllocations);
+        }
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *pointer, size_t size)
+    {
+        if (t_rtFrameDepth > 0)
+        {
+            rt_audit_violation(g_rtAllocations);
+        }
+        return __real_realloc(pointer, size);
+    }
+
+    int __wrap_posix_memalign(void **pointer, size_t alignment, size_t size)
+    {
+        if (t_rtFrameDepth > 0)
+        {
+            rt_audit_violation(g_rtAllocations);
+        }
+        return __real_posix_memalign(pointer, alignment, size);
+    }
+
+    void __wrap_free(void *pointer)
+    {
+        if (t_rtFrameDepth > 0 && pointer != nullptr)
+        {
+            rt_audit_violation(g_rtFrees);
+        }
+        __real_free(pointer);
+    }
+
+    int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex)
+    {
+        if (t_rtFrameDepth > 0)
+        {
+            rt_audit_violation(g_rtLocks);
+        }
+        return __real_pthread_mutex_lock(mutex);
+    }
+}
+#else
+#define RT_AUDIT_FRAME() ((void)0)
+#endif
+
+// ============================================================================
+// Pipeline Building Blocks (templates need C++ linkage, so they live here)
+// ============================================================================
+
+// Per-sample kernels: each consumes one sample per step() and keeps its own
+// running state. fused_pass() runs any set of them over a buffer in a single
+// loop; the set is a template parameter pack, so every call site compiles
+// to one inlined loop that reads each sample once.
+struct SumSquaresKernel
+{
+    float sum = 0.0f;
+    int count = 0;
+    inline void step(float x)
+    {
+        sum += x * x;
+        count++;
+    }
+    inline float rms() const { return (count > 0) ? sqrtf(sum / count) : 0.0f; }
+};
+
+struct PeakKernel
+{
+    float peak = 0.0f;
+    inline void step(float x)
+    {
+        float abs_val = fabsf(x);
+        if (abs_val > peak)
+            peak = abs_val;
+    }
+};
+
+template <typename... Kernels>
+static inline void fused_pass(const float *buffer, int length, int stride, Kernels &...kernels)
+{
+    for (int i = 0; i < length; i += stride)
+    {
+        float x = buffer[i];
+        int expand[] = {0, (kernels.step(x), 0)...};
+        (void)expand;
+    }
+}
+
+// Analysis stages: structs with `static bool run(AnalysisFrame *)`. A false
+// return ends the frame without an estimate. Pipeline<...> chains them in
+// order at compile time (no function pointers, fully inlinable). A new
+// stage is a new struct listed in GatePipeline (cheap, run on every window)
+// or EstimatePipeline (skipped by the governor); the front ends
+// (detect_pitch, the stream path) only ever call analyze_window.
+typedef struct
+{
+    const float *signal;  // Stage input/output (may be replaced by a stage)
+    int length;
+    int newSamples;       // Trailing samples not seen by a previous frame
+    int sampleRate;       // Rate of the original audio
+    const float *fullRate; // Denoised signal before decimation
+    int fullLength;
+    int yinRate;          // Rate `signal` is at after decimation
+    int decimation;       // Governor factor for this window (1 = none)
+    int onsetAge;         // Samples since an attack in the new audio (-1 = none)
+    float *yinBuffer;
+    int tau;              // Integer YIN lag at yinRate
+    float confidence;
+    float pitchHz;
+    TunerResult *result;
+} AnalysisFrame;
+
+template <typename... Stages>
+struct Pipeline;
+
+template <>
+struct Pipeline<>
+{
+    static inline bool run(AnalysisFrame *) { return true; }
+};
+
+template <typename First, typename... Rest>
+struct Pipeline<First, Rest...>
+{
+    static inline bool run(AnalysisFrame *frame)
+    {
+        return First::run(frame) && Pipeline<Rest...>::run(frame);
+    }
+};
+
 extern "C"
 {
+    static void smoothing_reset();
+
+    // ========================================================================
+    // Configuration: Publish the pending snapshot (setter side, wait-free)
+    // Setters are expected to be called from one thread at a time.
+    // ========================================================================
+    static void config_publish()
+    {
+        g_configSlots[g_configBack] = g_configPending;
+        int previous = g_configMiddle.exchange(g_configBack | CONFIG_DIRTY, std::memory_order_acq_rel);
+        g_configBack = previous & CONFIG_SLOT_MASK;
+    }
+
+    // ========================================================================
+    // Configuration: Adopt the newest snapshot (processing side, wait-free)
+    // Called at frame boundaries so a frame never sees half-applied state.
+    // ========================================================================
+    static void config_apply()
+    {
+        if ((g_configMiddle.load(std::memory_order_relaxed) & CONFIG_DIRTY) == 0)
+        {
+            return;
+        }
+        g_configFront = g_configMiddle.exchange(g_configFront, std::memory_order_acq_rel) & CONFIG_SLOT_MASK;
+        const TunerConfig *config = &g_configSlots[g_configFront];
+
+        if (config->mode != g_currentMode)
+        {
+            // Reset gate state on mode change
+            g_gateOpenSamples = 0;
+            g_gateCloseSamples = 0;
+            g_gateIsOpen = false;
+            g_lastValidPitch = -1.0f;
+            g_isIdle = false;
+            g_idleSamples = 0;
+            g_onsetEnergyAverage = 0.0f;
+            g_onsetRefractory = 0;
+            g_samplesSinceOnset = -1;
+            g_onsetBlockSum = 0.0f;
+            g_onsetBlockFill = 0;
+            smoothing_reset();
+        }
+
+        if (!config->humRejection && g_humRejectionEnabled)
+        {
+            g_humActive = false;
+            g_humNominal = 0.0f;
+            g_humFrequency = 0.0f;
+            g_humMissCounter = 0;
+            g_humHitCounter = 0;
+        }
+
+        if (config->denoiser && !g_denoiserEnabled && g_ssNoise != nullptr)
+        {
+            // Start learning afresh; the room may have changed
+            memset(g_ssNoise, 0, sizeof(float) * (SS_FFT_SIZE / 2 + 1));
+            g_ssLearnedFrames = 0;
+            g_ssLearnSamples = 0;
+        }
+
+        if (config->cpuBudget <= 0.0f)
+        {
+            // Governor off: back to full quality
+            g_governorLevel.store(0);
+            g_governorLoad.store(0.0f);
+            g_governorOverCount = 0;
+            g_governorUnderCount = 0;
+        }
+
+        g_currentMode = config->mode;
+        g_minFrequency = config->minFrequency;
+        g_maxFrequency = config->maxFrequency;
+        g_noiseThreshold = config->noiseThreshold;
+        g_humRejectionEnabled = config->humRejection;
+        g_denoiserEnabled = config->denoiser;
+        g_cpuBudget = config->cpuBudget;
+        g_trailReference = config->trailReference;
+    }
+
+    // ========================================================================
+    // Memory: Allocate an aligned, zeroed buffer (release with free)
+    // Zeroing touches every page, so the memory is resident before first use.
+    // ========================================================================
+    static void *aligned_zeroed_alloc(size_t bytes)
+    {
+        void *block = nullptr;
+        if (posix_memalign(&block, SCRATCH_ALIGNMENT, bytes) != 0)
+        {
+            return nullptr;
+        }
+        memset(block, 0, bytes);
+        return block;
+    }
+
+    // ========================================================================
+    // Arena: Round an offset up to the scratch alignment
+    // ========================================================================
+    static inline size_t arena_align(size_t offset)
+    {
+        return (offset + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+    }
+
+    // ========================================================================
+    // Arena: Bump-allocate aligned scratch (nullptr if it does not fit)
+    // ========================================================================
+    static void *arena_alloc(size_t bytes)
+    {
+        size_t start = arena_align(g_arenaUsed);
+        if (g_arenaBase == nullptr || start + bytes > g_arenaSize)
+        {
+            return nullptr;
+        }
+        g_arenaUsed = start + bytes;
+        return g_arenaBase + start;
+    }
+
+    // ========================================================================
+    // Arena: Start a frame, releasing the previous frame's scratch
+    // ========================================================================
+    static inline void arena_frame_begin()
+    {
+        g_arenaUsed = g_arenaSessionEnd;
+    }
 
     // ========================================================================
     // Configuration: Set tuning mode (affects noise gate sensitivity)
     // ========================================================================
     __attribute__((visibility("default"))) __attribute__((used)) void set_tuning_mode(int mode)
     {
-        g_currentMode = mode;
+        g_configPending.mode = mode;
 
         // Modes only affect noise gate threshold
         // Frequency range stays wide to support all tunings
         switch (mode)
         {
         case MODE_GUITAR:
-            g_noiseThreshold = NOISE_GATE_GUITAR;
+            g_configPending.noiseThreshold = NOISE_GATE_GUITAR;
             break;
         case MODE_PIANO:
-            g_noiseThreshold = NOISE_GATE_PIANO;
+            g_configPending.noiseThreshold = NOISE_GATE_PIANO;
             break;
         case MODE_CHROMATIC:
         default:
-            g_noiseThreshold = NOISE_GATE_CHROMATIC;
+            g_configPending.noiseThreshold = NOISE_GATE_CHROMATIC;
             break;
         }
 
-        // Reset gate state on mode change
-        g_gateOpenCounter = 0;
-        g_gateCloseCounter = 0;
-        g_gateIsOpen = false;
-        g_lastValidPitch = -1.0f;
+        // Gate state is reset when the processing side adopts the new mode
+        config_publish();
+    }
+
+    // ========================================================================
+    // Configuration: Set custom frequency range
+    // Use this for custom tunings (e.g., 7-string, drop tuning, bass guitar)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void set_frequency_range(float minFreq, float maxFreq)
+    {
+        if (minFreq > 0.0f && minFreq < maxFreq)
+        {
+            g_configPending.minFrequency = minFreq;
+            g_configPending.maxFrequency = maxFreq;
+            config_publish();
+        }
+    }
+
+    // ========================================================================
+    // Configuration: Reset frequency range to defaults
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void reset_frequency_range()
+    {
+        g_configPending.minFrequency = DEFAULT_MIN_FREQ;
+        g_configPending.maxFrequency = DEFAULT_MAX_FREQ;
+        config_publish();
+    }
+
+    // ========================================================================
+    // Configuration: Set custom noise gate threshold
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void set_noise_threshold(float threshold)
+    {
+        if (threshold > 0.0f && threshold < 1.0f)
+        {
+            g_configPending.noiseThreshold = threshold;
+            config_publish();
+        }
+    }
+
+    // ========================================================================
+    // Configuration: Enable/disable automatic mains hum rejection
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void set_hum_rejection(bool enabled)
+    {
+        // Hum state is cleared when the processing side adopts the change
+        g_configPending.humRejection = enabled;
+        config_publish();
+    }
+
+    // ========================================================================
+    // Configuration: Set the CPU budget as a fraction of real time
+    // 0.5 lets analysis use half the duration of the audio it covers; the
+    // governor lowers quality to stay within it. 0 disables the governor.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_set_cpu_budget(float budget)
+    {
+        if (budget >= 0.0f && budget <= 1.0f)
+        {
+            g_configPending.cpuBudget = budget;
+            config_publish();
+        }
+    }
+
+    // ========================================================================
+    // Governor test hook: account every analysis as if full quality took
+    // `load` of real time (scaled by each level's cost) instead of timing
+    // it, so the stepping logic can be checked on hosts of any speed.
+    // A negative load returns to measuring.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_governor_simulate_load(float load)
+    {
+        g_governorSimulatedLoad.store(load, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Configuration: Set the pitch the trail history is relative to
+    // With a target note selected the trail shows cents from it (clamped to
+    // +-100); 0 shows cents from the nearest equal-tempered note.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_set_trail_reference(float referenceHz)
+    {
+        if (referenceHz >= 0.0f)
+        {
+            g_configPending.trailReference = referenceHz;
+            config_publish();
+        }
+    }
+
+    // ========================================================================
+    // Governor: Monotonic time in seconds
+    // ========================================================================
+    static inline double governor_now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+    }
+
+    // Relative cost of a level (YIN dominates: quadratic in the window)
+    static inline float governor_cost(int level)
+    {
+        const GovernorLevel *l = &GOVERNOR_LEVELS[level];
+        return 1.0f / (float)(l->decimation * l->decimation * l->hopStride);
+    }
+
+    // ========================================================================
+    // Governor: Account one analysis that took `seconds` for `audioSamples`
+    // of new audio, and step the quality level down or up as needed.
+    // ========================================================================
+    static void governor_update(double seconds, int audioSamples, int sampleRate)
+    {
+        if (g_cpuBudget <= 0.0f || audioSamples <= 0 || sampleRate <= 0)
+        {
+            return;
+        }
+
+        int level = g_governorLevel.load(std::memory_order_relaxed);
+        float simulated = g_governorSimulatedLoad.load(std::memory_order_relaxed);
+        float load = (simulated >= 0.0f) ? simulated * governor_cost(level)
+                                         : (float)(seconds * sampleRate / audioSamples);
+        float average = g_governorLoad.load(std::memory_order_relaxed);
+        average = (average <= 0.0f) ? load : average + GOVERNOR_LOAD_SMOOTHING * (load - average);
+
+        if (average > g_cpuBudget && level < GOVERNOR_LEVEL_COUNT - 1)
+        {
+            g_governorUnderCount = 0;
+            if (++g_governorOverCount >= GOVERNOR_STEP_DOWN_COUNT)
+            {
+                // Carry the load over as predicted for the new level
+                average *= governor_cost(level + 1) / governor_cost(level);
+                level++;
+                g_governorOverCount = 0;
+            }
+        }
+        else if (level > 0 &&
+                 average * governor_cost(level - 1) / governor_cost(level) < g_cpuBudget * GOVERNOR_HEADROOM)
+        {
+            g_governorOverCount = 0;
+            if (++g_governorUnderCount >= GOVERNOR_STEP_UP_COUNT)
+            {
+                average *= governor_cost(level - 1) / governor_cost(level);
+                level--;
+                g_governorUnderCount = 0;
+            }
+        }
+        else
+        {
+            g_governorOverCount = 0;
+            g_governorUnderCount = 0;
+        }
+
+        g_governorLoad.store(average, std::memory_order_relaxed);
+        g_governorLevel.store(level, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Governor: Whether this hop (or frame) should be analyzed
+    // ========================================================================
+    static bool governor_take_hop()
+    {
+        int stride = GOVERNOR_LEVELS[g_governorLevel.load(std::memory_order_relaxed)].hopStride;
+        if (++g_governorHopsSkipped >= stride)
+        {
+            g_governorHopsSkipped = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // ========================================================================
+    // Governor: YIN decimation factor usable at this rate and level
+    // Keeps the decimated rate an integer and well above the highest pitch.
+    // ========================================================================
+    static int governor_decimation(int sampleRate)
+    {
+        int factor = GOVERNOR_LEVELS[g_governorLevel.load(std::memory_order_relaxed)].decimation;
+        while (factor > 1 &&
+               (sampleRate % factor != 0 ||
+                (float)(sampleRate / factor) < GOVERNOR_MIN_RATE_RATIO * g_maxFrequency))
+        {
+            factor /= 2;
+        }
+        return factor;
+    }
+
+    // ========================================================================
+    // Smoothing: Forget the previous note
+    // ========================================================================
+    static void smoothing_reset()
+    {
+        g_smoothHistoryCount = 0;
+        g_smoothHistoryIndex = 0;
+        g_smoothValid = false;
+        g_smoothVelocity = 0.0f;
+        g_smoothSamplesSinceUpdate = 0;
+    }
+
+    // ========================================================================
+    // Smoothing: Median of the recent raw estimates
+    // ========================================================================
+    static float smoothing_median()
+    {
+        float sorted[SMOOTH_MEDIAN_SIZE];
+        int n = g_smoothHistoryCount;
+        for (int i = 0; i < n; i++)
+        {
+            float v = g_smoothHistory[i];
+            int j = i;
+            while (j > 0 && sorted[j - 1] > v)
+            {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        return sorted[n / 2];
+    }
+
+    // ========================================================================
+    // Smoothing: Median + confidence-weighted Kalman update
+    // ========================================================================
+    static void smoothing_update(float pitchHz, float confidence, int sampleRate, TunerResult *result)
+    {
+        float dt = (float)g_smoothSamplesSinceUpdate / (float)sampleRate;
+        g_smoothSamplesSinceUpdate = 0;
+        if (dt > SMOOTH_MAX_GAP_SECONDS)
+        {
+            smoothing_reset();
+        }
+
+        // Absolute cents: MIDI note number * 100
+        float cents = 1200.0f * log2f(pitchHz / 440.0f) + 6900.0f;
+
+        g_smoothHistory[g_smoothHistoryIndex] = cents;
+        g_smoothHistoryIndex = (g_smoothHistoryIndex + 1) % SMOOTH_MEDIAN_SIZE;
+        if (g_smoothHistoryCount < SMOOTH_MEDIAN_SIZE)
+            g_smoothHistoryCount++;
+
+        float median = smoothing_median();
+        float measured = (fabsf(cents - median) > SMOOTH_OUTLIER_CENTS) ? median : cents;
+        float scale = 1.0f + (1.0f - confidence) * SMOOTH_CONFIDENCE_WEIGHT;
+        float R = SMOOTH_MEASUREMENT_NOISE * scale * scale;
+
+        if (!g_smoothValid || fabsf(measured - (g_smoothCents + g_smoothVelocity * dt)) > SMOOTH_RESET_CENTS)
+        {
+            g_smoothValid = true;
+            g_smoothCents = measured;
+            g_smoothVelocity = 0.0f;
+            g_smoothP00 = R;
+            g_smoothP01 = 0.0f;
+            g_smoothP11 = SMOOTH_ACCELERATION_NOISE;
+        }
+        else
+        {
+            // Predict: x = F x, P = F P F' + Q (white acceleration)
+            float dt2 = dt * dt;
+            float q = SMOOTH_ACCELERATION_NOISE;
+            g_smoothCents += g_smoothVelocity * dt;
+            float p00 = g_smoothP00 + 2.0f * dt * g_smoothP01 + dt2 * g_smoothP11 + q * dt2 * dt2 * 0.25f;
+            float p01 = g_smoothP01 + dt * g_smoothP11 + q * dt2 * dt * 0.5f;
+            float p11 = g_smoothP11 + q * dt2;
+
+            // Update with the median measurement
+            float innovation = measured - g_smoothCents;
+            float S = p00 + R;
+            float k0 = p00 / S;
+            float k1 = p01 / S;
+            g_smoothCents += k0 * innovation;
+            g_smoothVelocity += k1 * innovation;
+            g_smoothP00 = (1.0f - k0) * p00;
+            g_smoothP01 = (1.0f - k0) * p01;
+            g_smoothP11 = p11 - k1 * p01;
+        }
+
+        result->smoothedPitchHz = 440.0f * exp2f((g_smoothCents - 6900.0f) / 1200.0f);
+        result->driftCentsPerSecond = g_smoothVelocity;
+    }
+
+    // ========================================================================
+    // Noise Gate: Determines if signal should be processed
+    // Uses hysteresis to avoid rapid on/off switching
+    // ========================================================================
+    static bool noise_gate_check(float rms, float peak, int newSamples)
+    {
+        // Primary check: RMS above threshold
+        bool above_threshold = (rms > g_noiseThreshold);
+
+        // Secondary check: Peak should be reasonable (not just DC offset)
+        bool has_signal = (peak > g_noiseThreshold * 2.0f);
+
+        bool signal_present = above_threshold && has_signal;
+
+        if (signal_present)
+        {
+            g_gateCloseSamples = 0;
+            if (g_gateOpenSamples < NOISE_GATE_ATTACK_FRAMES * REFERENCE_FRAME_SAMPLES)
+            {
+                g_gateOpenSamples += newSamples;
+            }
+
+            // Open gate after sustained signal
+            if (g_gateOpenSamples >= NOISE_GATE_ATTACK_FRAMES * REFERENCE_FRAME_SAMPLES)
+            {
+                g_gateIsOpen = true;
+            }
+        }
+        else
+        {
+            g_gateOpenSamples = 0;
+            if (g_gateCloseSamples < IDLE_ENTER_FRAMES * REFERENCE_FRAME_SAMPLES)
+            {
+                g_gateCloseSamples += newSamples;
+            }
+
+            // Close gate after sustained silence
+            if (g_gateCloseSamples >= NOISE_GATE_RELEASE_FRAMES * REFERENCE_FRAME_SAMPLES)
+            {
+                g_gateIsOpen = false;
+                g_lastValidPitch = -1.0f;
+                smoothing_reset();
+            }
+        }
+
+        return g_gateIsOpen;
+    }
+
+    // ========================================================================
+    // Hum: Hann-windowed Goertzel power of a single frequency, as mean-square
+    // tone energy. The window keeps sidelobes of played notes from leaking
+    // into the 50/60 Hz probes.
+    // ========================================================================
+    static float goertzel_power(const float *buffer, int length, int stride, float freq, float sampleRate)
+    {
+        int count = (length + stride - 1) / stride;
+        if (count < 2)
+            return 0.0f;
+
+        float coeff = 2.0f * cosf(2.0f * (float)M_PI * freq * stride / sampleRate);
+
+        // Window phasor advanced by rotation instead of a cos() per sample
+        double step = 2.0 * M_PI / count;
+        double rotCos = cos(step);
+        double rotSin = sin(step);
+        double phaseCos = 1.0;
+        double phaseSin = 0.0;
+
+        float s1 = 0.0f;
+        float s2 = 0.0f;
+        for (int i = 0; i < length; i += stride)
+        {
+            float window = (float)(0.5 - 0.5 * phaseCos);
+            float s0 = buffer[i] * window + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+
+            double nextCos = phaseCos * rotCos - phaseSin * rotSin;
+            phaseSin = phaseSin * rotCos + phaseCos * rotSin;
+            phaseCos = nextCos;
+        }
+
+        // Hann coherent gain is 0.5
+        float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+        float norm = 0.5f * (float)count;
+        return 2.0f * power / (norm * norm);
+    }
+
+    // ========================================================================
+    // Hum: Score a 50/60 Hz harmonic family (sum of tonal harmonic power)
+    // Returns 0 if no harmonic stands out from its neighbours.
+    // ========================================================================
+    static float hum_family_score(const float *buffer, int length, float f0, float sampleRate, int *outStrongest)
+    {
+        float score = 0.0f;
+        float strongest = 0.0f;
+        *outStrongest = 1;
+
+        for (int h = 1; h <= HUM_HARMONICS; h++)
+        {
+            float f = f0 * h;
+            float p = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, f, sampleRate);
+            float lo = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, f - HUM_NEIGHBOR_OFFSET, sampleRate);
+            float hi = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, f + HUM_NEIGHBOR_OFFSET, sampleRate);
+
+            if (p > HUM_PEAK_RATIO * 0.5f * (lo + hi))
+            {
+                score += p;
+                if (p > strongest)
+                {
+                    strongest = p;
+                    *outStrongest = h;
+                }
+            }
+        }
+        return score;
+    }
+
+    // ========================================================================
+    // Hum: Fit the exact frequency of a harmonic with three Goertzel probes
+    // Returns the implied fundamental (parabolic peak over the probes).
+    // ========================================================================
+    static float hum_fit_frequency(const float *buffer, int length, int sampleRate, float f0, int harmonic)
+    {
+        float center = f0 * harmonic;
+        float span = HUM_TRACK_SPAN * harmonic;
+        float pl = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, center - span, (float)sampleRate);
+        float pc = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, center, (float)sampleRate);
+        float pr = goertzel_power(buffer, length, HUM_DETECT_DECIMATION, center + span, (float)sampleRate);
+
+        float offset = 0.0f;
+        float denominator = pl - 2.0f * pc + pr;
+        if (denominator < -1e-12f)
+        {
+            offset = 0.5f * (pl - pr) / denominator;
+            if (offset < -1.0f)
+                offset = -1.0f;
+            if (offset > 1.0f)
+                offset = 1.0f;
+        }
+        return (center + offset * span) / harmonic;
+    }
+
+    // ========================================================================
+    // Hum: Detect mains family and track its drift
+    // A candidate only counts if its fitted frequency sits within
+    // HUM_MAX_DRIFT of 50/60 Hz, so notes like G1 (49 Hz) are not notched.
+    // ========================================================================
+    static void hum_detect(const float *buffer, int length, int sampleRate)
+    {
+        int strongest50 = 1;
+        int strongest60 = 1;
+        float score50 = hum_family_score(buffer, length, HUM_NOMINAL_50, (float)sampleRate, &strongest50);
+        float score60 = hum_family_score(buffer, length, HUM_NOMINAL_60, (float)sampleRate, &strongest60);
+
+        float nominal = (score50 >= score60) ? HUM_NOMINAL_50 : HUM_NOMINAL_60;
+        float score = (score50 >= score60) ? score50 : score60;
+        int harmonic = (score50 >= score60) ? strongest50 : strongest60;
+
+        bool valid = false;
+        float estimate = 0.0f;
+        if (score >= HUM_MIN_LEVEL * HUM_MIN_LEVEL)
+        {
+            float center = (g_humActive && nominal == g_humNominal) ? g_humFrequency : nominal;
+            estimate = hum_fit_frequency(buffer, length, sampleRate, center, harmonic);
+            valid = fabsf(estimate - nominal) <= HUM_MAX_DRIFT;
+        }
+
+        if (!valid)
+        {
+            g_humHitCounter = 0;
+
+            // A played note can mask the hum; only release during silence
+            if (g_humActive && !g_gateIsOpen && ++g_humMissCounter >= HUM_RELEASE_DETECTIONS)
+            {
+                g_humActive = false;
+                g_humNominal = 0.0f;
+                g_humFrequency = 0.0f;
+            }
+            return;
+        }
+
+        g_humMissCounter = 0;
+        if (!g_humActive || nominal != g_humNominal)
+        {
+            // Hum is steady; a note that merely resembles it will not repeat
+            if (++g_humHitCounter < HUM_CONFIRM_DETECTIONS)
+            {
+                return;
+            }
+            g_humHitCounter = 0;
+
+            // New (or switched) mains family: restart the comb from silence
+            g_humNominal = nominal;
+            g_humFrequency = estimate;
+            g_humActive = true;
+            if (g_humOutput != nullptr)
+            {
+                memset(g_humOutput, 0, sizeof(float) * g_humHistory);
+            }
+            return;
+        }
+
+        g_humFrequency += HUM_TRACK_SMOOTHING * (estimate - g_humFrequency);
+    }
+
+    // ========================================================================
+    // Hum Rejection: run detection/tracking every HUM_DETECT_INTERVAL frames
+    // of audio, on the raw (unfiltered) most recent window
+    // ========================================================================
+    static void hum_schedule_detection(const float *raw, int length, int newSamples, int sampleRate)
+    {
+        if (!g_humRejectionEnabled)
+        {
+            return;
+        }
+
+        g_humDetectSamples -= newSamples;
+        if (g_humDetectSamples <= 0)
+        {
+            g_humDetectSamples = HUM_DETECT_INTERVAL * REFERENCE_FRAME_SAMPLES;
+            hum_detect(raw, length, sampleRate);
+        }
+    }
+
+    // ========================================================================
+    // Hum Rejection: fractional-delay IIR comb notch over consecutive audio
+    // Returns the buffer the rest of the pipeline should analyze.
+    // ========================================================================
+    static const float *hum_comb_process(const float *audioData, int length, int sampleRate)
+    {
+        if (!g_humRejectionEnabled)
+        {
+            return audioData;
+        }
+
+        // Buffers come from the arena, sized for the largest frame
+        if (g_humInput == nullptr || length > g_arenaMaxLength)
+        {
+            return audioData;
+        }
+
+        const int history = g_humHistory;
+        float *x = g_humInput + history;
+        float *y = g_humOutput + history;
+        memcpy(x, audioData, sizeof(float) * length);
+
+        const float *result = audioData;
+        if (g_humActive)
+        {
+            float delay = (float)sampleRate / g_humFrequency;
+            int di = (int)delay;
+            float frac = delay - (float)di;
+            float w0 = 1.0f - frac;
+            float w1 = frac;
+            const float rho = HUM_COMB_POLE;
+
+            // y[n] depends on y[n - di] and y[n - di - 1] only, so chunks of di
+            // samples carry no loop dependency and vectorize
+            for (int start = 0; start < length; start += di)
+            {
+                int end = (start + di < length) ? start + di : length;
+                const float *__restrict xs = x;
+                float *__restrict ys = y;
+                for (int n = start; n < end; n++)
+                {
+                    float xd = w0 * xs[n - di] + w1 * xs[n - di - 1];
+                    float yd = w0 * ys[n - di] + w1 * ys[n - di - 1];
+                    ys[n] = (xs[n] - xd) + rho * yd;
+                }
+            }
+
+            result = y;
+        }
+
+        // Slide the last `history` samples to the front for the next frame.
+        // The caller is done with `result` before the next call overwrites it.
+        memmove(g_humInput, g_humInput + length, sizeof(float) * history);
+        if (g_humActive)
+        {
+            memmove(g_humOutput, g_humOutput + length, sizeof(float) * history);
+        }
+        return result;
+    }
+
+    // ========================================================================
+    // Denoiser: Build the FFT plan (twiddles, bit reversal, window)
+    // ========================================================================
+    static void denoiser_plan_init()
+    {
+        const int n = SS_FFT_SIZE;
+        for (int k = 0; k < n / 2; k++)
+        {
+            double angle = -2.0 * M_PI * k / n;
+            g_ssCos[k] = (float)cos(angle);
+            g_ssSin[k] = (float)sin(angle);
+        }
+
+        int bits = 0;
+        while ((1 << bits) < n)
+            bits++;
+        for (int i = 0; i < n; i++)
+        {
+            int r = 0;
+            for (int b = 0; b < bits; b++)
+            {
+                if (i & (1 << b))
+                    r |= 1 << (bits - 1 - b);
+            }
+            g_ssBitReverse[i] = r;
+        }
+
+        // Periodic Hann sums to 1 at 50% overlap, so sqrt-Hann on both
+        // analysis and synthesis gives perfect reconstruction
+        for (int i = 0; i < n; i++)
+        {
+            g_ssWindow[i] = (float)sqrt(0.5 * (1.0 - cos(2.0 * M_PI * i / n)));
+        }
+    }
+
+    // ========================================================================
+    // Denoiser: In-place iterative radix-2 complex FFT using the plan
+    // ========================================================================
+    static void denoiser_fft(float *re, float *im, bool inverse)
+    {
+        const int n = SS_FFT_SIZE;
+
+        for (int i = 0; i < n; i++)
+        {
+            int j = g_ssBitReverse[i];
+            if (j > i)
+            {
+                float tr = re[i];
+                re[i] = re[j];
+                re[j] = tr;
+                float ti = im[i];
+                im[i] = im[j];
+                im[j] = ti;
+            }
+        }
+
+        const float sign = inverse ? -1.0f : 1.0f;
+        for (int size = 2; size <= n; size <<= 1)
+        {
+            int half = size >> 1;
+            int step = n / size;
+            for (int start = 0; start < n; start += size)
+            {
+                for (int k = 0; k < half; k++)
+                {
+                    float wr = g_ssCos[k * step];
+                    float wi = sign * g_ssSin[k * step];
+                    int a = start + k;
+                    int b = a + half;
+                    float tr = re[b] * wr - im[b] * wi;
+                    float ti = re[b] * wi + im[b] * wr;
+                    re[b] = re[a] - tr;
+                    im[b] = im[a] - ti;
+                    re[a] += tr;
+                    im[a] += ti;
+                }
+            }
+        }
+    }
+
+    // ========================================================================
+    // Denoiser: Window one STFT frame (zero outside the block) and transform
+    // ========================================================================
+    static void denoiser_analyze(const float *buffer, int length, int start)
+    {
+        for (int i = 0; i < SS_FFT_SIZE; i++)
+        {
+            int idx = start + i;
+            g_ssRe[i] = (idx >= 0 && idx < length) ? buffer[idx] * g_ssWindow[i] : 0.0f;
+            g_ssIm[i] = 0.0f;
+        }
+        denoiser_fft(g_ssRe, g_ssIm, false);
+    }
+
+    // ========================================================================
+    // Denoiser: Learn noise spectrum from closed-gate audio
+    // SS_LEARN_FRAMES_PER_BLOCK STFT frames per reference frame of new audio,
+    // spread over the newest part of the window.
+    // ========================================================================
+    static void denoiser_learn_noise(const float *buffer, int length, int newSamples)
+    {
+        if (length < SS_FFT_SIZE)
+        {
+            return;
+        }
+
+        const int interval = REFERENCE_FRAME_SAMPLES / SS_LEARN_FRAMES_PER_BLOCK;
+        g_ssLearnSamples += newSamples;
+        int frames = g_ssLearnSamples / interval;
+        if (frames == 0)
+        {
+            return;
+        }
+        g_ssLearnSamples -= frames * interval;
+        if (frames > SS_LEARN_FRAMES_PER_BLOCK)
+        {
+            frames = SS_LEARN_FRAMES_PER_BLOCK;
+        }
+
+        int region = (newSamples < length) ? newSamples : length;
+        if (region < SS_FFT_SIZE)
+        {
+            region = SS_FFT_SIZE;
+        }
+        int regionStart = length - region;
+        int span = region - SS_FFT_SIZE;
+
+        const int bins = SS_FFT_SIZE / 2 + 1;
+        for (int f = 0; f < frames; f++)
+        {
+            int start = regionStart + ((frames > 1) ? span * f / (frames - 1) : span);
+            denoiser_analyze(buffer, length, start);
+
+            // Plain average during warm-up, then a slow exponential update
+            float rate = (g_ssLearnedFrames < SS_LEARN_WARMUP) ? 1.0f / (g_ssLearnedFrames + 1) : SS_LEARN_RATE;
+            for (int k = 0; k < bins; k++)
+            {
+                float mag = sqrtf(g_ssRe[k] * g_ssRe[k] + g_ssIm[k] * g_ssIm[k]);
+                g_ssNoise[k] += rate * (mag - g_ssNoise[k]);
+            }
+            g_ssLearnedFrames++;
+        }
+    }
+
+    // ========================================================================
+    // Denoiser: Spectral subtraction with overlap-add resynthesis
+    // Returns the buffer the rest of the pipeline should analyze.
+    // ========================================================================
+    static const float *denoiser_process(const float *buffer, int length)
+    {
+        if (g_ssLearnedFrames < SS_MIN_LEARN_FRAMES)
+        {
+            return buffer;
+        }
+        float *output = (float *)arena_alloc(sizeof(float) * length);
+        if (output == nullptr)
+        {
+            return buffer;
+        }
+
+        const int n = SS_FFT_SIZE;
+        const float invN = 1.0f / n;
+        memset(output, 0, sizeof(float) * length);
+
+        // Frames start one hop before the block so every sample is covered twice
+        for (int start = -SS_HOP_SIZE; start < length; start += SS_HOP_SIZE)
+        {
+            denoiser_analyze(buffer, length, start);
+
+            for (int k = 0; k <= n / 2; k++)
+            {
+                float mag = sqrtf(g_ssRe[k] * g_ssRe[k] + g_ssIm[k] * g_ssIm[k]);
+                float cleaned = mag - SS_OVERSUBTRACTION * g_ssNoise[k];
+                float floorMag = SS_SPECTRAL_FLOOR * mag;
+                if (cleaned < floorMag)
+                    cleaned = floorMag;
+                float gain = (mag > 0.0f) ? cleaned / mag : 0.0f;
+
+                g_ssRe[k] *= gain;
+                g_ssIm[k] *= gain;
+                if (k > 0 && k < n / 2)
+                {
+                    g_ssRe[n - k] *= gain;
+                    g_ssIm[n - k] *= gain;
+                }
+            }
+
+            denoiser_fft(g_ssRe, g_ssIm, true);
+
+            int first = (start < 0) ? -start : 0;
+            int last = (start + n > length) ? length - start : n;
+            for (int i = first; i < last; i++)
+            {
+                output[start + i] += g_ssRe[i] * invN * g_ssWindow[i];
+            }
+        }
+
+        return output;
+    }
+
+    // ========================================================================
+    // Configuration: Enable/disable the spectral subtraction denoiser
+    // Allocates nothing: the FFT plan and STFT work areas are built with the
+    // arena (arena_create), and each frame's output is bumped from it.
+    // Enabling restarts noise learning at the next frame boundary.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void set_spectral_denoiser(bool enabled)
+    {
+        g_configPending.denoiser = enabled;
+        config_publish();
+    }
+
+    // ========================================================================
+    // Arena: History the hum comb keeps ahead of each frame
+    // Must cover the longest comb delay plus one for interpolation.
+    // ========================================================================
+    static inline int hum_history_samples(int sampleRate)
+    {
+        return (int)(sampleRate / (HUM_NOMINAL_50 - HUM_MAX_DRIFT)) + 2;
+    }
+
+    // ========================================================================
+    // Arena: Exact footprint in bytes (same order as arena_create + a frame)
+    // ========================================================================
+    static size_t arena_footprint(int maxLength, int sampleRate)
+    {
+        const int n = SS_FFT_SIZE;
+        const size_t humBytes = sizeof(float) * (hum_history_samples(sampleRate) + maxLength);
+        const size_t sizes[] = {
+            // Session: persist across frames
+            humBytes,                          // g_humInput
+            humBytes,                          // g_humOutput
+            sizeof(float) * (n / 2),           // g_ssCos
+            sizeof(float) * (n / 2),           // g_ssSin
+            sizeof(int) * n,                   // g_ssBitReverse
+            sizeof(float) * n,                 // g_ssWindow
+            sizeof(float) * n,                 // g_ssRe
+            sizeof(float) * n,                 // g_ssIm
+            sizeof(float) * (n / 2 + 1),       // g_ssNoise
+            sizeof(float) * maxLength,         // g_streamRaw
+            sizeof(float) * maxLength,         // g_streamFiltered
+            // Per frame: largest case is a stream hop with the denoiser on
+            sizeof(float) * maxLength,         // Unrolled stream window
+            sizeof(float) * maxLength,         // Denoiser output
+            sizeof(float) * (maxLength / 2),   // Decimated window (governor)
+            sizeof(float) * (maxLength / 2),   // YIN difference function
+        };
+
+        size_t total = 0;
+        for (size_t bytes : sizes)
+        {
+            total = arena_align(total) + bytes;
+        }
+        return total;
+    }
+
+    // ========================================================================
+    // Arena: (Re)create for frames up to maxLength at sampleRate
+    // Everything starts zeroed, so hum history, the learned noise profile and
+    // the stream restart; tuner_stream_configure must be called again.
+    // ========================================================================
+    static bool arena_create(int maxLength, int sampleRate)
+    {
+        size_t size = arena_footprint(maxLength, sampleRate);
+        uint8_t *base = (uint8_t *)aligned_zeroed_alloc(size);
+        if (base == nullptr)
+        {
+            return false;
+        }
+
+        if (g_memoryLocked)
+        {
+            munlock(g_arenaBase, g_arenaSize);
+            g_memoryLocked = false;
+        }
+        free(g_arenaBase);
+        g_arenaBase = base;
+        g_arenaSize = size;
+        g_arenaUsed = 0;
+        g_arenaMaxLength = maxLength;
+        g_arenaSampleRate = sampleRate;
+
+        const int n = SS_FFT_SIZE;
+        g_humHistory = hum_history_samples(sampleRate);
+        g_humInput = (float *)arena_alloc(sizeof(float) * (g_humHistory + maxLength));
+        g_humOutput = (float *)arena_alloc(sizeof(float) * (g_humHistory + maxLength));
+        g_ssCos = (float *)arena_alloc(sizeof(float) * (n / 2));
+        g_ssSin = (float *)arena_alloc(sizeof(float) * (n / 2));
+        g_ssBitReverse = (int *)arena_alloc(sizeof(int) * n);
+        g_ssWindow = (float *)arena_alloc(sizeof(float) * n);
+        g_ssRe = (float *)arena_alloc(sizeof(float) * n);
+        g_ssIm = (float *)arena_alloc(sizeof(float) * n);
+        g_ssNoise = (float *)arena_alloc(sizeof(float) * (n / 2 + 1));
+        g_streamRaw = (float *)arena_alloc(sizeof(float) * maxLength);
+        g_streamFiltered = (float *)arena_alloc(sizeof(float) * maxLength);
+        g_arenaSessionEnd = g_arenaUsed;
+
+        denoiser_plan_init();
+        g_ssLearnedFrames = 0;
+        g_ssLearnSamples = 0;
+        g_streamWindow = 0;
+        return true;
+    }
+
+    // ========================================================================
+    // Arena: Make sure the layout covers a frame of this length and rate
+    // Grows (re-creates) on demand unless tuner_prepare fixed the layout.
+    // ========================================================================
+    static bool arena_ensure(int length, int sampleRate)
+    {
+        if (g_arenaBase != nullptr && length <= g_arenaMaxLength && sampleRate == g_arenaSampleRate)
+        {
+            return true;
+        }
+        if (g_prepared)
+        {
+            return false;
+        }
+        return arena_create((length > g_arenaMaxLength) ? length : g_arenaMaxLength, sampleRate);
+    }
+
+    // ========================================================================
+    // Onset: Find the latest energy attack in the new audio at block resolution
+    // Blocks run continuously across calls: a trailing partial block is
+    // carried and completed by the next call, so short or odd-sized hops are
+    // covered too. Returns the samples from the start of the attack's block
+    // to the end of the buffer (which may exceed length), or -1 if none.
+    // ========================================================================
+    static int onset_detect(const float *buffer, int length)
+    {
+        const float minEnergy = g_noiseThreshold * g_noiseThreshold;
+        int age = -1;
+
+        int i = 0;
+        while (i < length)
+        {
+            int take = ONSET_BLOCK_SIZE - g_onsetBlockFill;
+            if (take > length - i)
+                take = length - i;
+            float sum = g_onsetBlockSum;
+            for (int end = i + take; i < end; i++)
+            {
+                sum += buffer[i] * buffer[i];
+            }
+            g_onsetBlockFill += take;
+            if (g_onsetBlockFill < ONSET_BLOCK_SIZE)
+            {
+                g_onsetBlockSum = sum;
+                break;
+            }
+            g_onsetBlockSum = 0.0f;
+            g_onsetBlockFill = 0;
+            float energy = sum / ONSET_BLOCK_SIZE;
+
+            if (g_onsetRefractory > 0)
+            {
+                g_onsetRefractory--;
+            }
+            else if (energy > minEnergy && energy > ONSET_ENERGY_RATIO * g_onsetEnergyAverage)
+            {
+                age = length - i + ONSET_BLOCK_SIZE;
+                g_onsetRefractory = ONSET_REFRACTORY_BLOCKS;
+            }
+
+            g_onsetEnergyAverage = ONSET_ENERGY_DECAY * g_onsetEnergyAverage + (1.0f - ONSET_ENERGY_DECAY) * energy;
+        }
+        return age;
+    }
+
+    // ========================================================================
+    // Onset: Open the gate immediately and forget the previous note
+    // ========================================================================
+    static void onset_reset_tracking()
+    {
+        g_gateOpenSamples = NOISE_GATE_ATTACK_FRAMES * REFERENCE_FRAME_SAMPLES;
+        g_gateCloseSamples = 0;
+        g_gateIsOpen = true;
+        g_lastValidPitch = -1.0f;
+        smoothing_reset();
+    }
+
+    // ========================================================================
+    // Governor: Downsample by a power of two for a cheaper YIN
+    // Each halving is a [1 2 1]/4 low-pass then every other sample; only
+    // the first pass reads the input, later ones run in place.
+    // ========================================================================
+    static void yin_decimate(const float *input, int length, int factor, float *output)
+    {
+        const float *source = input;
+        for (; factor > 1; factor /= 2)
+        {
+            int half = length / 2;
+            for (int j = 0; j < half; j++)
+            {
+                int i = 2 * j;
+                float previous = (i > 0) ? source[i - 1] : source[i];
+                output[j] = 0.25f * previous + 0.5f * source[i] + 0.25f * source[i + 1];
+            }
+            source = output;
+            length = half;
+        }
+    }
+
+    // ========================================================================
+    // Step 1: Autocorrelation-based Difference Function
+    // ========================================================================
+    static inline float yin_lag_difference(const float *buffer, int halfLen, int tau)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < halfLen; i++)
+        {
+            float delta = buffer[i] - buffer[i + tau];
+            sum += delta * delta;
+        }
+        return sum;
+    }
+
+    static void yin_difference(const float *buffer, float *yinBuffer, int bufferLength, int tauLimit)
+    {
+        int halfLen = bufferLength / 2;
+        memset(yinBuffer, 0, sizeof(float) * tauLimit);
+
+        for (int tau = 1; tau < tauLimit; tau++)
+        {
+            yinBuffer[tau] = yin_lag_difference(buffer, halfLen, tau);
+        }
+    }
+
+    // ========================================================================
+    // Step 1b: Lags the later steps can look at (maxTau plus one for the
+    // interpolation neighbour). Lags beyond it are never computed.
+    // ========================================================================
+    static inline int yin_tau_limit(int bufferLength, int sampleRate)
+    {
+        int limit = (int)(sampleRate / g_minFrequency) + 1;
+        return (limit < bufferLength / 2) ? limit : bufferLength / 2;
+    }
+
+    // ========================================================================
+    // Step 2: Cumulative Mean Normalized Difference Function (CMND)
+    // ========================================================================
+    static void yin_cumulative_mean_normalized_difference(float *yinBuffer, int tauLimit)
+    {
+        yinBuffer[0] = 1.0f;
+
+        float runningSum = 0.0f;
+        for (int tau = 1; tau < tauLimit; tau++)
+        {
+            runningSum += yinBuffer[tau];
+            if (runningSum > 0.0f)
+            {
+                yinBuffer[tau] = yinBuffer[tau] * tau / runningSum;
+            }
+            else
+            {
+                yinBuffer[tau] = 1.0f;
+            }
+        }
+    }
+
+    // ========================================================================
+    // Step 3: Absolute Threshold with mode-aware frequency bounds
+    // ========================================================================
+    static int yin_absolute_threshold(const float *yinBuffer, int bufferLength, int sampleRate, float *confidence)
+    {
+        int halfLen = bufferLength / 2;
+
+        // Calculate min/max tau based on current mode frequency bounds
+        int minTau = (int)(sampleRate / g_maxFrequency);
+        int maxTau = (int)(sampleRate / g_minFrequency);
+
+        if (minTau < 2)
+            minTau = 2;
+        if (maxTau > halfLen - 1)
+            maxTau = halfLen - 1;
+
+        int bestTau = -1;
+        float bestValue = YIN_THRESHOLD;
+
+        for (int tau = minTau; tau < maxTau; tau++)
+        {
+            if (yinBuffer[tau] < YIN_THRESHOLD)
+            {
+                while (tau + 1 < maxTau && yinBuffer[tau + 1] < yinBuffer[tau])
+                {
+                    tau++;
+                }
+
+                if (yinBuffer[tau] < bestValue)
+                {
+                    bestValue = yinBuffer[tau];
+                    bestTau = tau;
+                }
+                break;
+            }
+        }
+
+        *confidence = (bestTau != -1) ? (1.0f - bestValue) : 0.0f;
+        return bestTau;
+    }
+
+    // ========================================================================
+    // Helper: Vertex offset (-1..1) of the parabola through three points
+    // ========================================================================
+    static inline float parabolic_vertex(float s0, float s1, float s2)
+    {
+        float denominator = 2.0f * (2.0f * s1 - s2 - s0);
+
+        if (fabsf(denominator) < 1e-9f)
+        {
+            return 0.0f;
+        }
+
+        float adjustment = (s2 - s0) / denominator;
+
+        if (adjustment < -1.0f)
+            adjustment = -1.0f;
+        if (adjustment > 1.0f)
+            adjustment = 1.0f;
+
+        return adjustment;
+    }
+
+    // ========================================================================
+    // Step 4: Parabolic Interpolation
+    // ========================================================================
+    static float yin_parabolic_interpolation(const float *yinBuffer, int tau, int bufferLength)
+    {
+        int halfLen = bufferLength / 2;
+
+        if (tau < 1 || tau >= halfLen - 1)
+        {
+            return (float)tau;
+        }
+
+        return (float)tau + parabolic_vertex(yinBuffer[tau - 1], yinBuffer[tau], yinBuffer[tau + 1]);
+    }
+
+    // ========================================================================
+    // Governor: Refine a lag found at the decimated rate
+    // Evaluates the difference function at full rate around factor * tau
+    // (a handful of lags) and interpolates there, so high notes keep their
+    // full-rate precision. Returns the lag in full-rate samples.
+    // ========================================================================
+    static float yin_refine_lag(const float *buffer, int length, int tau, int factor)
+    {
+        int halfLen = length / 2;
+        int first = tau * factor - factor;
+        int last = tau * factor + factor;
+        if (first < 2)
+            first = 2;
+        if (last > halfLen - 2)
+            last = halfLen - 2;
+        if (first > last)
+        {
+            return (float)(tau * factor);
+        }
+
+        int bestLag = first;
+        float bestValue = FLT_MAX;
+        for (int lag = first; lag <= last; lag++)
+        {
+            float value = yin_lag_difference(buffer, halfLen, lag);
+            if (value < bestValue)
+            {
+                bestValue = value;
+                bestLag = lag;
+            }
+        }
+
+        float before = yin_lag_difference(buffer, halfLen, bestLag - 1);
+        float after = yin_lag_difference(buffer, halfLen, bestLag + 1);
+        return (float)bestLag + parabolic_vertex(before, bestValue, after);
+    }
+
+    // ========================================================================
+    // Idle Mode: cheap energy probe while nobody is playing
+    // Returns true if the window should go on to full analysis.
+    // ========================================================================
+    static bool idle_mode_check(const float *audioData, int length, int newSamples)
+    {
+        if (!g_isIdle)
+        {
+            return true;
+        }
+
+        // Reduced rate: skip windows between probes entirely
+        g_idleSamples += newSamples;
+        if (g_idleSamples < IDLE_FRAME_INTERVAL * REFERENCE_FRAME_SAMPLES)
+        {
+            return false;
+        }
+        g_idleSamples = 0;
+
+        SumSquaresKernel energy;
+        PeakKernel peak;
+        fused_pass(audioData, length, IDLE_DECIMATION, energy, peak);
+
+        float wakeThreshold = g_noiseThreshold * IDLE_WAKE_RATIO;
+        if (energy.rms() <= wakeThreshold && peak.peak <= wakeThreshold * 2.0f)
+        {
+            return false;
+        }
+
+        // Energy appeared - leave idle and analyze this same window in full
+        g_isIdle = false;
+        g_gateCloseSamples = 0;
+        return true;
+    }
+
+    // ========================================================================
+    // Stage: Idle (skip windows while nobody is playing)
+    // ========================================================================
+    struct IdleStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            return idle_mode_check(f->signal, f->length, f->newSamples);
+        }
+    };
+
+    // ========================================================================
+    // Stage: Onset (restart tracking on an attack, skip the transient)
+    // ========================================================================
+    struct OnsetStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            // Only the new audio can hold a new attack
+            f->onsetAge = onset_detect(f->signal + (f->length - f->newSamples), f->newSamples);
+            if (f->onsetAge >= 0)
+            {
+                onset_reset_tracking();
+                g_samplesSinceOnset = f->onsetAge;
+            }
+            else if (g_samplesSinceOnset >= 0)
+            {
+                g_samplesSinceOnset += f->newSamples;
+            }
+
+            // After an attack, analyze only what follows the transient, once
+            // there is enough of it for the lowest allowed pitch
+            if (g_samplesSinceOnset >= 0)
+            {
+                int usable = g_samplesSinceOnset - ONSET_SKIP_SAMPLES;
+                if (usable >= f->length)
+                {
+                    g_samplesSinceOnset = -1;
+                }
+                else
+                {
+                    int required = 2 * ((int)(f->sampleRate / g_minFrequency) + 2);
+                    if (usable < required)
+                    {
+                        return false;
+                    }
+                    f->signal += f->length - usable;
+                    f->newSamples = (f->newSamples < usable) ? f->newSamples : usable;
+                    f->length = usable;
+                }
+            }
+            return true;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Gate (energy with hysteresis; RMS and peak in one fused pass)
+    // ========================================================================
+    struct GateStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            // A fresh attack bypasses the gate's attack hysteresis
+            if (f->onsetAge >= 0)
+            {
+                return true;
+            }
+
+            SumSquaresKernel energy;
+            PeakKernel peak;
+            fused_pass(f->signal, f->length, 1, energy, peak);
+
+            // Noise gate check with hysteresis
+            if (noise_gate_check(energy.rms(), peak.peak, f->newSamples))
+            {
+                return true;
+            }
+
+            // Nobody is playing: this is what the room sounds like
+            if (g_denoiserEnabled)
+            {
+                denoiser_learn_noise(f->signal, f->length, f->newSamples);
+            }
+
+            // Long enough silence: drop into low-power idle mode
+            if (g_gateCloseSamples >= IDLE_ENTER_FRAMES * REFERENCE_FRAME_SAMPLES)
+            {
+                g_isIdle = true;
+                g_idleSamples = 0;
+            }
+            return false;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Filter (spectral-subtraction denoiser, when enabled)
+    // ========================================================================
+    struct DenoiseStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            if (g_denoiserEnabled)
+            {
+                f->signal = denoiser_process(f->signal, f->length);
+            }
+            f->fullRate = f->signal;
+            f->fullLength = f->length;
+            return true;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Decimate (governor: run YIN at a lower rate when short on CPU)
+    // Runs only for windows past the gate, so silence never pays for it.
+    // ========================================================================
+    struct DecimateStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            f->yinRate = f->sampleRate;
+            if (f->decimation <= 1)
+            {
+                return true;
+            }
+
+            float *decimated = (float *)arena_alloc(sizeof(float) * (f->length / f->decimation));
+            if (decimated == nullptr)
+            {
+                return false;
+            }
+            yin_decimate(f->signal, f->length, f->decimation, decimated);
+            f->signal = decimated;
+            f->length /= f->decimation;
+            f->yinRate /= f->decimation;
+            return true;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Detect (YIN difference, CMND and absolute threshold)
+    // ========================================================================
+    struct YinStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            f->yinBuffer = (float *)arena_alloc(sizeof(float) * (f->length / 2));
+            if (f->yinBuffer == nullptr)
+            {
+                return false;
+            }
+
+            int tauLimit = yin_tau_limit(f->length, f->yinRate);
+            yin_difference(f->signal, f->yinBuffer, f->length, tauLimit);
+            yin_cumulative_mean_normalized_difference(f->yinBuffer, tauLimit);
+
+            f->confidence = 0.0f;
+            f->tau = yin_absolute_threshold(f->yinBuffer, f->length, f->yinRate, &f->confidence);
+            return f->tau != -1;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Refine (sub-sample lag, then the final frequency range check)
+    // ========================================================================
+    struct RefineStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            if (f->decimation > 1)
+            {
+                f->pitchHz = (float)f->sampleRate / yin_refine_lag(f->fullRate, f->fullLength, f->tau, f->decimation);
+            }
+            else
+            {
+                float betterTau = yin_parabolic_interpolation(f->yinBuffer, f->tau, f->length);
+                f->pitchHz = (float)f->sampleRate / betterTau;
+            }
+            return f->pitchHz >= g_minFrequency && f->pitchHz <= g_maxFrequency;
+        }
+    };
+
+    // ========================================================================
+    // Stage: Smooth (median + Kalman) and publish into the result
+    // ========================================================================
+    struct SmoothStage
+    {
+        static inline bool run(AnalysisFrame *f)
+        {
+            f->result->pitchHz = f->pitchHz;
+            f->result->confidence = f->confidence;
+            smoothing_update(f->pitchHz, f->confidence, f->sampleRate, f->result);
+
+            // Store as last valid pitch for stability
+            g_lastValidPitch = f->pitchHz;
+            return true;
+        }
+    };
+
+    typedef Pipeline<IdleStage, OnsetStage, GateStage> GatePipeline;
+    typedef Pipeline<DenoiseStage, DecimateStage, YinStage, RefineStage, SmoothStage> EstimatePipeline;
+
+    // ========================================================================
+    // Shared analysis entry: runs GatePipeline, then EstimatePipeline, over
+    // one window. `signal` is the most recent `length` samples (already
+    // hum-filtered), of which the last `newSamples` have not been seen by a
+    // previous call. Returns true if `result` holds a pitch estimate.
+    // A window the governor skips still goes through the gate: silence
+    // clears the estimate, an attack is analyzed in full after all, and
+    // otherwise the last estimate is repeated and *repeated set.
+    // ========================================================================
+    static bool analyze_window(const float *signal, int length, int newSamples, int sampleRate, TunerResult *result,
+                               bool skipped, bool *repeated)
+    {
+        *repeated = false;
+        result->pitchHz = -1.0f;
+        result->confidence = 0.0f;
+        result->smoothedPitchHz = -1.0f;
+        result->driftCentsPerSecond = 0.0f;
+
+        if (signal == nullptr || length < 64)
+        {
+            return false;
+        }
+        if (newSamples > length)
+        {
+            newSamples = length;
+        }
+
+        // Audio time since the last estimate drives the Kalman prediction
+        g_smoothSamplesSinceUpdate += newSamples;
+
+        AnalysisFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.signal = signal;
+        frame.length = length;
+        frame.newSamples = newSamples;
+        frame.sampleRate = sampleRate;
+        frame.onsetAge = -1;
+        frame.decimation = skipped ? 1 : governor_decimation(sampleRate);
+        frame.tau = -1;
+        frame.result = result;
+        if (!GatePipeline::run(&frame))
+        {
+            g_governorLastResult = *result;
+            return false;
+        }
+
+        if (skipped && frame.onsetAge < 0)
+        {
+            *result = g_governorLastResult;
+            *repeated = true;
+            return result->pitchHz > 0.0f;
+        }
+        if (skipped)
+        {
+            g_governorHopsSkipped = 0; // A new note: restart the stride from here
+            frame.decimation = governor_decimation(sampleRate);
+        }
+
+        bool found = EstimatePipeline::run(&frame);
+        g_governorLastResult = *result;
+        return found;
+    }
+
+    // ========================================================================
+    // Trail: Displayed offset in cents for a pitch
+    // ========================================================================
+    static float trail_cents(float pitchHz)
+    {
+        if (g_trailReference > 0.0f)
+        {
+            float cents = 1200.0f * log2f(pitchHz / g_trailReference);
+            return fminf(fmaxf(cents, -TRAIL_CENTS_LIMIT), TRAIL_CENTS_LIMIT);
+        }
+        float midi = 12.0f * log2f(pitchHz / 440.0f) + 69.0f;
+        return (midi - roundf(midi)) * 100.0f;
+    }
+
+    static void trail_append(float cents)
+    {
+        uint32_t head = g_trail.head;
+        g_trail.cents[head & (TRAIL_CAPACITY - 1)] = cents;
+        __atomic_store_n(&g_trail.head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    // ========================================================================
+    // Trail: Record one estimate covering `samples` of audio
+    // Entries are spaced evenly in audio time, so the trail spans the same
+    // time on screen whatever the hop or frame size. A pitched estimate is
+    // reached by a straight ramp from the previous one. Silence is recorded
+    // as NAN: the UI decides how it is drawn (standby lives there).
+    // ========================================================================
+    static void trail_record(const TunerResult *result, int samples, int sampleRate)
+    {
+        float pitch = result->smoothedPitchHz;
+        float target = (pitch > TRAIL_PITCH_MIN && pitch < TRAIL_PITCH_MAX) ? trail_cents(pitch) : NAN;
+
+        g_trailDue += (int64_t)samples * TRAIL_ENTRY_RATE;
+        int count = (int)(g_trailDue / sampleRate);
+        if (count == 0)
+        {
+            return;
+        }
+        g_trailDue -= (int64_t)count * sampleRate;
+
+        float from = g_trailLast;
+        bool ramp = !isnan(from) && !isnan(target);
+        for (int k = 1; k <= count; k++)
+        {
+            trail_append(ramp ? from + (target - from) * k / count : target);
+        }
+        g_trailLast = target;
+    }
+
+    // ========================================================================
+    // Engine state: Copy gate/idle/hum state out for the getters
+    // Called by the processing thread at the end of every frame or hop.
+    // ========================================================================
+    static inline void state_report()
+    {
+        g_reportedGateOpen.store(g_gateIsOpen, std::memory_order_relaxed);
+        g_reportedIdle.store(g_isIdle, std::memory_order_relaxed);
+        g_reportedHumFrequency.store(g_humActive ? g_humFrequency : 0.0f, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Whole-frame front end: consecutive, non-overlapping frames
+    // While the analysis thread runs it owns the arena and every piece of
+    // tracking state, so frames handed in directly get no pitch and change
+    // nothing. Do not start the thread while a detect_* call is in progress.
+    // ========================================================================
+    static bool analyze_frame(float *audioData, int length, int sampleRate, TunerResult *result)
+    {
+        RT_AUDIT_FRAME();
+
+        bool repeated;
+        if (audioData == nullptr || length < 64 || g_analysisRunning.load(std::memory_order_acquire))
+        {
+            return analyze_window(nullptr, 0, 0, sampleRate, result, false, &repeated);
+        }
+
+        // Scratch covers the largest frame so far, or exactly the prepared one
+        if (!arena_ensure(length, sampleRate))
+        {
+            return analyze_window(nullptr, 0, 0, sampleRate, result, false, &repeated);
+        }
+        arena_frame_begin();
+        config_apply();
+        double start = governor_now();
+
+        // Mains hum removal runs on every frame so the comb state stays continuous
+        hum_schedule_detection(audioData, length, length, sampleRate);
+        const float *signal = hum_comb_process(audioData, length, sampleRate);
+
+        // Frames arrive at a fixed rate, so a skipped one repeats the last
+        // estimate while the gate stays open
+        g_governorFrameSamples += length;
+        bool analyze = governor_take_hop();
+        bool found = analyze_window(signal, length, length, sampleRate, result, !analyze, &repeated);
+        if (analyze)
+        {
+            governor_update(governor_now() - start, g_governorFrameSamples, sampleRate);
+            g_governorFrameSamples = 0;
+        }
+        trail_record(result, length, sampleRate);
+        state_report();
+        return found;
+    }
+
+    // ========================================================================
+    // MAIN FUNCTION: detect_pitch
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float detect_pitch(float *audioData, int length, int sampleRate)
+    {
+        TunerResult result;
+        analyze_frame(audioData, length, sampleRate, &result);
+        return result.pitchHz;
+    }
+
+    // ========================================================================
+    // EXTENDED FUNCTION: detect_pitch_with_confidence
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float detect_pitch_with_confidence(float *audioData, int length, int sampleRate, float *outConfidence)
+    {
+        TunerResult result;
+        analyze_frame(audioData, length, sampleRate, &result);
+
+        if (outConfidence != nullptr)
+        {
+            *outConfidence = result.confidence;
+        }
+        return result.pitchHz;
+    }
+
+    // ========================================================================
+    // EXTENDED FUNCTION: detect_pitch_smoothed
+    // Fills `outResult` with raw and smoothed pitch plus drift rate, and
+    // returns the smoothed pitch (or -1 if nothing was detected).
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float detect_pitch_smoothed(float *audioData, int length, int sampleRate, TunerResult *outResult)
+    {
+        TunerResult result;
+        analyze_frame(audioData, length, sampleRate, &result);
+
+        if (outResult != nullptr)
+        {
+            *outResult = result;
+        }
+        return result.smoothedPitchHz;
+    }
+
+    // ========================================================================
+    // REAL-TIME SETUP: Preallocate all processing scratch
+    // Creates the arena for frames up to maxLength: 64-byte aligned,
+    // pre-faulted and, with lockMemory, mlock()ed (best effort, see
+    // is_memory_locked). Afterwards the detect_* calls and the stream never
+    // allocate, and frames longer than maxLength or at another sample rate
+    // are rejected (no pitch). Call before tuner_stream_configure.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) bool tuner_prepare(int maxLength, int sampleRate, bool lockMemory)
+    {
+        if (maxLength < 64 || maxLength > STREAM_MAX_WINDOW || sampleRate <= 0 || g_analysisRunning.load())
+        {
+            return false;
+        }
+
+        g_prepared = false;
+        if (!arena_create(maxLength, sampleRate))
+        {
+            return false;
+        }
+        g_prepared = true;
+
+        if (lockMemory)
+        {
+            g_memoryLocked = (mlock(g_arenaBase, g_arenaSize) == 0);
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // Get the engine-owned input buffer, growing it to at least `capacity`
+    // samples. One buffer serves every caller and growing frees the old one,
+    // so callers that may run side by side (isolates) must not use it: new
+    // code takes its own buffer from tuner_input_buffer_alloc instead.
+    // Returns nullptr (old buffer kept) if the size is invalid or memory is short.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float *tuner_input_buffer(int capacity)
+    {
+        if (capacity <= 0 || capacity > INPUT_BUFFER_MAX_CAPACITY)
+        {
+            return nullptr;
+        }
+        if (capacity > g_inputCapacity)
+        {
+            float *buffer = (float *)aligned_zeroed_alloc(sizeof(float) * capacity);
+            if (buffer == nullptr)
+            {
+                return nullptr;
+            }
+            free(g_inputBuffer);
+            g_inputBuffer = buffer;
+            g_inputCapacity = capacity;
+        }
+        return g_inputBuffer;
+    }
+
+    // ========================================================================
+    // Allocate an input buffer of `capacity` samples for one caller
+    // Dart wraps it with asTypedList and writes capture data into it, then
+    // passes the same pointer to detect_pitch / tuner_push /
+    // tuner_capture_write, which read it in place. Each engine (and each
+    // isolate) owns its own, so no other caller can move or overwrite it.
+    // Aligned and pre-faulted like the arena; release with
+    // tuner_input_buffer_free. Returns nullptr if the size is invalid or
+    // memory is short.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float *tuner_input_buffer_alloc(int capacity)
+    {
+        if (capacity <= 0 || capacity > INPUT_BUFFER_MAX_CAPACITY)
+        {
+            return nullptr;
+        }
+        return (float *)aligned_zeroed_alloc(sizeof(float) * capacity);
+    }
+
+    // ========================================================================
+    // Release a buffer from tuner_input_buffer_alloc (nullptr is ignored)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_input_buffer_free(float *buffer)
+    {
+        free(buffer);
+    }
+
+    // ========================================================================
+    // Get the exact scratch footprint in bytes (0 before the first frame)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) size_t tuner_memory_footprint()
+    {
+        return g_arenaSize;
+    }
+
+    // ========================================================================
+    // Real-time audit: Read the counters (false unless built with the audit)
+    // Every field but frames should stay 0 once tuner_prepare has run.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) bool tuner_rt_audit(TunerRtAudit *outAudit)
+    {
+        if (outAudit == nullptr)
+        {
+            return false;
+        }
+#ifdef NOTEFY_RT_AUDIT
+        outAudit->frames = g_rtFrames.load();
+        outAudit->allocations = g_rtAllocations.load();
+        outAudit->frees = g_rtFrees.load();
+        outAudit->locks = g_rtLocks.load();
+        return true;
+#else
+        memset(outAudit, 0, sizeof(TunerRtAudit));
+        return false;
+#endif
+    }
+
+    // ========================================================================
+    // Real-time audit: Zero the counters and choose count or trap (abort)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_rt_audit_reset(bool trap)
+    {
+#ifdef NOTEFY_RT_AUDIT
+        g_rtFrames.store(0);
+        g_rtAllocations.store(0);
+        g_rtFrees.store(0);
+        g_rtLocks.store(0);
+        g_rtTrap.store(trap);
+#else
+        (void)trap;
+#endif
+    }
+
+    // ========================================================================
+    // Streaming: Unroll a ring into linear (window-sized), oldest sample first
+    // ========================================================================
+    static void stream_unroll(float *linear, const float *ring)
+    {
+        int tail = g_streamWindow - g_streamWritePos;
+        memcpy(linear, ring + g_streamWritePos, sizeof(float) * tail);
+        memcpy(linear + tail, ring, sizeof(float) * g_streamWritePos);
+    }
+
+    // ========================================================================
+    // Shared result: Publish one estimate (single writer at a time)
+    // ========================================================================
+    // Field accesses are relaxed atomics so a torn read is merely retried
+    // rather than being a data race; the sequence orders them.
+    static inline void shared_store(float *field, float value)
+    {
+        __atomic_store(field, &value, __ATOMIC_RELAXED);
+    }
+
+    static inline float shared_load(const float *field)
+    {
+        float value;
+        __atomic_load(field, &value, __ATOMIC_RELAXED);
+        return value;
+    }
+
+    static inline void shared_store_f64(double *field, double value)
+    {
+        __atomic_store(field, &value, __ATOMIC_RELAXED);
+    }
+
+    static void shared_result_publish(const TunerResult *result, const TunerTiming *timing)
+    {
+        uint32_t sequence = g_sharedResult.sequence;
+        __atomic_store_n(&g_sharedResult.sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        __atomic_store_n(&g_sharedResult.count, g_sharedResult.count + 1, __ATOMIC_RELAXED);
+        shared_store(&g_sharedResult.pitchHz, result->pitchHz);
+        shared_store(&g_sharedResult.confidence, result->confidence);
+        shared_store(&g_sharedResult.smoothedPitchHz, result->smoothedPitchHz);
+        shared_store(&g_sharedResult.driftCentsPerSecond, result->driftCentsPerSecond);
+        shared_store(&g_sharedResult.humFrequency, g_humActive ? g_humFrequency : 0.0f);
+        __atomic_store_n(&g_sharedResult.gateOpen, g_gateIsOpen ? 1u : 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_sharedResult.idle, g_isIdle ? 1u : 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_sharedResult.qualityLevel, (uint32_t)g_governorLevel.load(), __ATOMIC_RELAXED);
+        shared_store_f64(&g_sharedResult.timing.audioTime, timing->audioTime);
+        shared_store_f64(&g_sharedResult.timing.blockArrival, timing->blockArrival);
+        shared_store_f64(&g_sharedResult.timing.analysisStart, timing->analysisStart);
+        shared_store_f64(&g_sharedResult.timing.analysisEnd, timing->analysisEnd);
+
+        __atomic_store_n(&g_sharedResult.sequence, sequence + 2, __ATOMIC_RELEASE);
     }
 
     // ========================================================================
-    // Configuration: Set custom frequency range
-    // Use this for custom tunings (e.g., 7-string, drop tuning, bass guitar)
+    // Streaming: Analyze the current window and publish the estimate
+    // hopEndTime is when the newest sample in the window was captured. A hop
+    // the governor skips (`analyze` false) only runs the gate, and publishes
+    // nothing unless the gate closed or an attack was found.
+    // Returns true if a result was published.
     // ========================================================================
-    __attribute__((visibility("default"))) __attribute__((used)) void set_frequency_range(float minFreq, float maxFreq)
+    static bool stream_analyze(double hopEndTime, bool analyze)
     {
-        if (minFreq > 0.0f && minFreq < maxFreq)
+        int newSamples = (g_streamPending < g_streamWindow) ? g_streamPending : g_streamWindow;
+        g_streamPending = 0;
+        double start = governor_now();
+
+        arena_frame_begin();
+        float *linear = (float *)arena_alloc(sizeof(float) * g_streamWindow);
+        if (linear == nullptr)
         {
-            g_minFrequency = minFreq;
-            g_maxFrequency = maxFreq;
+            return false;
         }
-    }
 
-    // ========================================================================
-    // Configuration: Reset frequency range to defaults
-    // ========================================================================
-    __attribute__((visibility("default"))) __attribute__((used)) void reset_frequency_range()
-    {
-        g_minFrequency = DEFAULT_MIN_FREQ;
-        g_maxFrequency = DEFAULT_MAX_FREQ;
+        if (g_humRejectionEnabled)
+        {
+            stream_unroll(linear, g_streamRaw);
+            hum_schedule_detection(linear, g_streamWindow, newSamples, g_streamSampleRate);
+        }
+
+        stream_unroll(linear, g_streamFiltered);
+        TunerResult result;
+        bool repeated;
+        analyze_window(linear, g_streamWindow, newSamples, g_streamSampleRate, &result, !analyze, &repeated);
+        double end = governor_now();
+        if (analyze)
+        {
+            governor_update(end - start, newSamples, g_streamSampleRate);
+        }
+        trail_record(&result, newSamples, g_streamSampleRate);
+        state_report();
+        if (repeated)
+        {
+            return false;
+        }
+
+        TunerTiming timing;
+        timing.audioTime = hopEndTime - 0.5 * g_streamWindow / g_streamSampleRate;
+        timing.blockArrival = g_streamArrival;
+        timing.analysisStart = start;
+        timing.analysisEnd = end;
+        shared_result_publish(&result, &timing);
+        return true;
     }
 
     // ========================================================================
-    // Configuration: Set custom noise gate threshold
+    // STREAMING API: Configure window, hop and sample rate
+    // Allocates the rings and scratch here so tuner_push never has to.
+    // Also clears any buffered audio and pending result.
     // ========================================================================
-    __attribute__((visibility("default"))) __attribute__((used)) void set_noise_threshold(float threshold)
+    __attribute__((visibility("default"))) __attribute__((used)) bool tuner_stream_configure(int windowSize, int hopSize, int sampleRate)
     {
-        if (threshold > 0.0f && threshold < 1.0f)
+        if (windowSize < STREAM_MIN_WINDOW || windowSize > STREAM_MAX_WINDOW ||
+            hopSize < 1 || hopSize > windowSize || sampleRate <= 0 ||
+            g_analysisRunning.load())
         {
-            g_noiseThreshold = threshold;
+            return false;
         }
+        // Rings and all stage scratch come from the arena. Everything the
+        // worker needs exists afterwards, so it never allocates.
+        if (!arena_ensure(windowSize, sampleRate))
+        {
+            return false;
+        }
+
+        g_streamWindow = windowSize;
+        memset(g_streamRaw, 0, sizeof(float) * windowSize);
+        memset(g_streamFiltered, 0, sizeof(float) * windowSize);
+        g_streamHop = hopSize;
+        g_streamSampleRate = sampleRate;
+        g_streamWritePos = 0;
+        g_streamFilled = 0;
+        g_streamSinceHop = 0;
+        g_streamPending = 0;
+        g_streamArrival = 0.0;
+        g_streamEndTime = 0.0;
+
+        // Whatever is in the shared block now predates this configuration
+        g_pollCount.store(g_sharedResult.count);
+        return true;
     }
 
     // ========================================================================
-    // Helper: Calculate RMS energy of the signal
+    // Streaming: Feed one block into the rings, analyzing at each hop.
+    // g_streamArrival / g_streamEndTime describe the block being pushed.
     // ========================================================================
-    static inline float calculate_rms(const float *buffer, int length)
+    static int stream_push(const float *samples, int n)
     {
-        float sum = 0.0f;
-        for (int i = 0; i < length; i++)
+        RT_AUDIT_FRAME();
+
+        config_apply();
+
+        int produced = 0;
+        while (n > 0)
         {
-            sum += buffer[i] * buffer[i];
+            // Never cross a hop boundary within one piece
+            int piece = g_streamHop - g_streamSinceHop;
+            if (piece > n)
+                piece = n;
+
+            const float *filtered = hum_comb_process(samples, piece, g_streamSampleRate);
+
+            int first = g_streamWindow - g_streamWritePos;
+            if (first > piece)
+                first = piece;
+            memcpy(g_streamRaw + g_streamWritePos, samples, sizeof(float) * first);
+            memcpy(g_streamFiltered + g_streamWritePos, filtered, sizeof(float) * first);
+            memcpy(g_streamRaw, samples + first, sizeof(float) * (piece - first));
+            memcpy(g_streamFiltered, filtered + first, sizeof(float) * (piece - first));
+            g_streamWritePos = (g_streamWritePos + piece) % g_streamWindow;
+
+            g_streamFilled = (g_streamFilled + piece < g_streamWindow) ? g_streamFilled + piece : g_streamWindow;
+            if (g_streamPending < g_streamWindow)
+                g_streamPending += piece;
+            g_streamSinceHop += piece;
+            samples += piece;
+            n -= piece;
+
+            if (g_streamSinceHop >= g_streamHop)
+            {
+                g_streamSinceHop = 0;
+                if (g_streamFilled >= g_streamWindow)
+                {
+                    // The hop ends n samples before the end of the block
+                    if (stream_analyze(g_streamEndTime - (double)n / g_streamSampleRate, governor_take_hop()))
+                    {
+                        produced++;
+                    }
+                }
+            }
         }
-        return sqrtf(sum / length);
+        return produced;
     }
 
     // ========================================================================
-    // Helper: Calculate peak amplitude (for additional noise detection)
+    // STREAMING API: Push captured samples (any block size)
+    // Runs one analysis per completed hop once a full window is buffered.
+    // Returns the number of estimates produced by this call.
+    // While the analysis thread is running, feed tuner_capture_write instead;
+    // samples pushed here are ignored then.
     // ========================================================================
-    static inline float calculate_peak(const float *buffer, int length)
+    __attribute__((visibility("default"))) __attribute__((used)) int tuner_push(const float *samples, int n)
     {
-        float peak = 0.0f;
-        for (int i = 0; i < length; i++)
+        if (g_streamWindow == 0 || samples == nullptr || n <= 0 ||
+            g_analysisRunning.load(std::memory_order_acquire))
         {
-            float abs_val = fabsf(buffer[i]);
-            if (abs_val > peak)
-                peak = abs_val;
+            return 0;
         }
-        return peak;
+
+        // A pushed block arrives now, its last sample just captured
+        g_streamArrival = governor_now();
+        g_streamEndTime = g_streamArrival;
+        return stream_push(samples, n);
     }
 
     // ========================================================================
-    // Noise Gate: Determines if signal should be processed
-    // Uses hysteresis to avoid rapid on/off switching
+    // Helper: Read the shared block if it is newer than *cursor
+    // Each reader keeps its own cursor (the last count it returned), so
+    // tuner_poll and the worker's callback never take each other's results.
     // ========================================================================
-    static bool noise_gate_check(float rms, float peak)
+    static bool shared_result_poll(uint32_t *cursor, TunerResult *outResult)
     {
-        // Primary check: RMS above threshold
-        bool above_threshold = (rms > g_noiseThreshold);
-
-        // Secondary check: Peak should be reasonable (not just DC offset)
-        bool has_signal = (peak > g_noiseThreshold * 2.0f);
-
-        bool signal_present = above_threshold && has_signal;
-
-        if (signal_present)
+        // Seqlock read of the shared block; the writer never waits on us.
+        // A read that keeps racing the writer reports nothing new this time.
+        for (int attempt = 0; attempt < 4; attempt++)
         {
-            g_gateCloseCounter = 0;
-            g_gateOpenCounter++;
-
-            // Open gate after sustained signal
-            if (g_gateOpenCounter >= NOISE_GATE_ATTACK_FRAMES)
+            uint32_t sequence = __atomic_load_n(&g_sharedResult.sequence, __ATOMIC_ACQUIRE);
+            if (sequence & 1)
             {
-                g_gateIsOpen = true;
+                continue;
+            }
+            uint32_t count = __atomic_load_n(&g_sharedResult.count, __ATOMIC_RELAXED);
+            TunerResult result;
+            result.pitchHz = shared_load(&g_sharedResult.pitchHz);
+            result.confidence = shared_load(&g_sharedResult.confidence);
+            result.smoothedPitchHz = shared_load(&g_sharedResult.smoothedPitchHz);
+            result.driftCentsPerSecond = shared_load(&g_sharedResult.driftCentsPerSecond);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&g_sharedResult.sequence, __ATOMIC_RELAXED) != sequence)
+            {
+                continue;
             }
-        }
-        else
-        {
-            g_gateOpenCounter = 0;
-            g_gateCloseCounter++;
 
-            // Close gate after sustained silence
-            if (g_gateCloseCounter >= NOISE_GATE_RELEASE_FRAMES)
+            if (count == *cursor)
             {
-                g_gateIsOpen = false;
-                g_lastValidPitch = -1.0f;
+                return false;
             }
+            *cursor = count;
+            *outResult = result;
+            return true;
         }
-
-        return g_gateIsOpen;
+        return false;
     }
 
     // ========================================================================
-    // Step 1: Autocorrelation-based Difference Function
+    // STREAMING API: Fetch the latest estimate
+    // Returns true (and fills outResult) if a new estimate arrived since the
+    // previous poll. A fresh estimate may still report no pitch (-1).
     // ========================================================================
-    static void yin_difference(const float *buffer, float *yinBuffer, int bufferLength)
+    __attribute__((visibility("default"))) __attribute__((used)) bool tuner_poll(TunerResult *outResult)
     {
-        int halfLen = bufferLength / 2;
-        memset(yinBuffer, 0, sizeof(float) * halfLen);
-
-        for (int tau = 1; tau < halfLen; tau++)
+        if (outResult == nullptr)
         {
-            float sum = 0.0f;
-            for (int i = 0; i < halfLen; i++)
-            {
-                float delta = buffer[i] - buffer[i + tau];
-                sum += delta * delta;
-            }
-            yinBuffer[tau] = sum;
+            return false;
+        }
+        uint32_t cursor = g_pollCount.load();
+        if (!shared_result_poll(&cursor, outResult))
+        {
+            return false;
         }
+        g_pollCount.store(cursor);
+        return true;
     }
 
     // ========================================================================
-    // Step 2: Cumulative Mean Normalized Difference Function (CMND)
+    // STREAMING API: Address of the shared result block
+    // Valid for the lifetime of the library; map it once and read it with
+    // the sequence protocol described at TunerSharedResult.
     // ========================================================================
-    static void yin_cumulative_mean_normalized_difference(float *yinBuffer, int bufferLength)
+    __attribute__((visibility("default"))) __attribute__((used)) const TunerSharedResult *tuner_shared_result()
     {
-        int halfLen = bufferLength / 2;
-        yinBuffer[0] = 1.0f;
-
-        float runningSum = 0.0f;
-        for (int tau = 1; tau < halfLen; tau++)
-        {
-            runningSum += yinBuffer[tau];
-            if (runningSum > 0.0f)
-            {
-                yinBuffer[tau] = yinBuffer[tau] * tau / runningSum;
-            }
-            else
-            {
-                yinBuffer[tau] = 1.0f;
-            }
-        }
+        return &g_sharedResult;
     }
 
     // ========================================================================
-    // Step 3: Absolute Threshold with mode-aware frequency bounds
+    // TRAIL: Address of the displayed-cents history ring
+    // Valid for the lifetime of the library. Read head, then the entries
+    // below it; an entry is only overwritten TRAIL_CAPACITY entries later
+    // (over a minute of audio).
     // ========================================================================
-    static int yin_absolute_threshold(const float *yinBuffer, int bufferLength, int sampleRate, float *confidence)
+    __attribute__((visibility("default"))) __attribute__((used)) const TunerTrail *tuner_trail()
     {
-        int halfLen = bufferLength / 2;
-
-        // Calculate min/max tau based on current mode frequency bounds
-        int minTau = (int)(sampleRate / g_maxFrequency);
-        int maxTau = (int)(sampleRate / g_minFrequency);
-
-        if (minTau < 2)
-            minTau = 2;
-        if (maxTau > halfLen - 1)
-            maxTau = halfLen - 1;
-
-        int bestTau = -1;
-        float bestValue = YIN_THRESHOLD;
+        return &g_trail;
+    }
 
-        for (int tau = minTau; tau < maxTau; tau++)
+    // ========================================================================
+    // CAPTURE RING: Enter/leave a producer call
+    // A writer counts itself in before it checks that the ring is running;
+    // tuner_analysis_stop clears the flag before it waits for the count to
+    // drain. Both sides are sequentially consistent, so either the writer
+    // sees the ring closed or stop sees the writer, and the ring and its
+    // semaphore outlive every write that got in.
+    // ========================================================================
+    static inline bool capture_enter()
+    {
+        g_captureWriters.fetch_add(1);
+        if (g_analysisRunning.load())
         {
-            if (yinBuffer[tau] < YIN_THRESHOLD)
-            {
-                while (tau + 1 < maxTau && yinBuffer[tau + 1] < yinBuffer[tau])
-                {
-                    tau++;
-                }
-
-                if (yinBuffer[tau] < bestValue)
-                {
-                    bestValue = yinBuffer[tau];
-                    bestTau = tau;
-                }
-                break;
-            }
+            return true;
         }
+        g_captureWriters.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
 
-        *confidence = (bestTau != -1) ? (1.0f - bestValue) : 0.0f;
-        return bestTau;
+    static inline void capture_leave()
+    {
+        g_captureWriters.fetch_sub(1, std::memory_order_release);
     }
 
     // ========================================================================
-    // Step 4: Parabolic Interpolation
+    // CAPTURE RING: Claim space for up to n samples (producer side)
+    // Drops and counts what does not fit. Returns the number claimed; they
+    // go at ring offset *outStart, wrapping after *outFirst samples.
+    // Call between capture_enter and capture_leave.
     // ========================================================================
-    static float yin_parabolic_interpolation(const float *yinBuffer, int tau, int bufferLength)
+    static uint32_t capture_claim(int n, uint32_t *outWrite, uint32_t *outStart, uint32_t *outFirst)
     {
-        int halfLen = bufferLength / 2;
-
-        if (tau < 1 || tau >= halfLen - 1)
+        if (n <= 0)
         {
-            return (float)tau;
+            return 0;
         }
 
-        float s0 = yinBuffer[tau - 1];
-        float s1 = yinBuffer[tau];
-        float s2 = yinBuffer[tau + 1];
-
-        float denominator = 2.0f * (2.0f * s1 - s2 - s0);
+        uint32_t write = g_captureWriteIndex.load(std::memory_order_relaxed);
+        uint32_t read = g_captureReadIndex.load(std::memory_order_acquire);
+        uint32_t space = g_captureCapacity - (write - read);
 
-        if (fabsf(denominator) < 1e-9f)
+        uint32_t count = (uint32_t)n;
+        if (count > space)
         {
-            return (float)tau;
+            g_captureOverruns.fetch_add(count - space, std::memory_order_relaxed);
+            count = space;
         }
 
-        float adjustment = (s2 - s0) / denominator;
-
-        if (adjustment < -1.0f)
-            adjustment = -1.0f;
-        if (adjustment > 1.0f)
-            adjustment = 1.0f;
+        uint32_t start = write & g_captureMask;
+        uint32_t first = g_captureCapacity - start;
+        *outWrite = write;
+        *outStart = start;
+        *outFirst = (first > count) ? count : first;
+        return count;
+    }
 
-        return (float)tau + adjustment;
+    // Publish claimed samples to the analysis thread, stamped with the time
+    // they arrived. The stamp is stored before the index that releases it.
+    static inline void capture_commit(uint32_t write, uint32_t count)
+    {
+        double now = governor_now();
+        uint32_t stamp = g_captureStampWrite.load(std::memory_order_relaxed);
+        CaptureStamp *slot = &g_captureStamps[stamp & (CAPTURE_STAMP_COUNT - 1)];
+        __atomic_store_n(&slot->end, write + count, __ATOMIC_RELAXED);
+        __atomic_store(&slot->time, &now, __ATOMIC_RELAXED);
+        g_captureStampWrite.store(stamp + 1, std::memory_order_relaxed);
+
+        g_captureWriteIndex.store(write + count, std::memory_order_release);
+        capture_signal_post(&g_captureSignal);
     }
 
     // ========================================================================
-    // Helper: Ensure YIN buffer is allocated
+    // Helper: Narrow doubles to floats. A plain restrict loop, which the
+    // compiler turns into vector conversions (NEON fcvtn / SSE cvtpd2ps).
     // ========================================================================
-    static bool ensure_yin_buffer(int halfLen)
+    static inline void convert_f64_to_f32(float *__restrict dst, const double *__restrict src, uint32_t n)
     {
-        if (g_yinBuffer == nullptr || g_yinBufferSize < halfLen)
+        for (uint32_t i = 0; i < n; i++)
         {
-            if (g_yinBuffer != nullptr)
-            {
-                free(g_yinBuffer);
-            }
-            g_yinBuffer = (float *)malloc(sizeof(float) * halfLen);
-            g_yinBufferSize = halfLen;
-
-            if (g_yinBuffer == nullptr)
-            {
-                return false;
-            }
+            dst[i] = (float)src[i];
         }
-        return true;
     }
 
     // ========================================================================
-    // MAIN FUNCTION: detect_pitch
+    // CAPTURE RING: Producer side (audio callback)
+    // Wait-free: never blocks, locks or allocates. Samples that do not fit
+    // are dropped and counted as overruns. Returns the number accepted.
+    // Safe as an FFI leaf call, so Dart can pass a Float32List's own memory.
     // ========================================================================
-    __attribute__((visibility("default"))) __attribute__((used)) float detect_pitch(float *audioData, int length, int sampleRate)
+    __attribute__((visibility("default"))) __attribute__((used)) int tuner_capture_write(const float *samples, int n)
     {
-        if (audioData == nullptr || length < 64)
+        if (samples == nullptr || !capture_enter())
         {
-            return -1.0f;
+            return 0;
         }
 
-        // Calculate signal energy
-        float rms = calculate_rms(audioData, length);
-        float peak = calculate_peak(audioData, length);
-
-        // Noise gate check with hysteresis
-        if (!noise_gate_check(rms, peak))
+        uint32_t write, start, first;
+        uint32_t count = capture_claim(n, &write, &start, &first);
+        if (count > 0)
         {
-            return -1.0f;
+            memcpy(g_captureRing + start, samples, sizeof(float) * first);
+            memcpy(g_captureRing, samples + first, sizeof(float) * (count - first));
+            capture_commit(write, count);
         }
+        capture_leave();
+        return (int)count;
+    }
 
-        int halfLen = length / 2;
-
-        if (!ensure_yin_buffer(halfLen))
+    // ========================================================================
+    // CAPTURE RING: Producer side for double samples (e.g. a Float64List)
+    // Converts straight into the ring; otherwise as tuner_capture_write.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) int tuner_capture_write_f64(const double *samples, int n)
+    {
+        if (samples == nullptr || !capture_enter())
         {
-            return -1.0f;
+            return 0;
         }
 
-        // YIN Algorithm
-        yin_difference(audioData, g_yinBuffer, length);
-        yin_cumulative_mean_normalized_difference(g_yinBuffer, length);
-
-        float confidence = 0.0f;
-        int tau = yin_absolute_threshold(g_yinBuffer, length, sampleRate, &confidence);
-
-        if (tau == -1)
+        uint32_t write, start, first;
+        uint32_t count = capture_claim(n, &write, &start, &first);
+        if (count > 0)
         {
-            return -1.0f;
+            convert_f64_to_f32(g_captureRing + start, samples, first);
+            convert_f64_to_f32(g_captureRing, samples + first, count - first);
+            capture_commit(write, count);
         }
+        capture_leave();
+        return (int)count;
+    }
 
-        float betterTau = yin_parabolic_interpolation(g_yinBuffer, tau, length);
-        float pitchHz = (float)sampleRate / betterTau;
-
-        // Final frequency range check
-        if (pitchHz < g_minFrequency || pitchHz > g_maxFrequency)
+    // ========================================================================
+    // CAPTURE RING: Arrival time of the samples from read on (consumer side)
+    // Trims *chunk so it ends within one block, then sets the stream's
+    // arrival and end-sample times for it. Stamps the producer has lapped
+    // (more than CAPTURE_STAMP_COUNT blocks behind) are skipped; the chunk
+    // then takes the oldest stamp still held, which can only be later.
+    // ========================================================================
+    static void capture_block_timing(uint32_t read, uint32_t *chunk)
+    {
+        uint32_t written = g_captureStampWrite.load(std::memory_order_relaxed);
+        if (written - g_captureStampRead > CAPTURE_STAMP_COUNT)
         {
-            return -1.0f;
+            g_captureStampRead = written - CAPTURE_STAMP_COUNT;
         }
 
-        // Store as last valid pitch for stability
-        g_lastValidPitch = pitchHz;
+        while (g_captureStampRead != written)
+        {
+            const CaptureStamp *slot = &g_captureStamps[g_captureStampRead & (CAPTURE_STAMP_COUNT - 1)];
+            uint32_t end = __atomic_load_n(&slot->end, __ATOMIC_RELAXED);
+            uint32_t ahead = end - read;
+            if (ahead == 0 || ahead > g_captureCapacity)
+            {
+                // Block already consumed
+                g_captureStampRead++;
+                continue;
+            }
+
+            if (*chunk > ahead)
+                *chunk = ahead;
+            double time;
+            __atomic_load(&slot->time, &time, __ATOMIC_RELAXED);
+            g_streamArrival = time;
+            g_streamEndTime = time - (double)(ahead - *chunk) / g_streamSampleRate;
+            return;
+        }
 
-        return pitchHz;
+        // No stamp (cannot happen for committed samples): treat as just arrived
+        g_streamArrival = governor_now();
+        g_streamEndTime = g_streamArrival;
     }
 
     // ========================================================================
-    // EXTENDED FUNCTION: detect_pitch_with_confidence
+    // CAPTURE RING: Consumer side (analysis thread)
+    // Drains everything available straight out of the ring into the stream,
+    // one capture block at a time so each push has a single arrival time.
     // ========================================================================
-    __attribute__((visibility("default"))) __attribute__((used)) float detect_pitch_with_confidence(float *audioData, int length, int sampleRate, float *outConfidence)
+    static void analysis_thread_main()
     {
-        if (outConfidence != nullptr)
+        while (g_analysisRunning.load(std::memory_order_acquire))
         {
-            *outConfidence = 0.0f;
-        }
+            capture_signal_wait(&g_captureSignal);
 
-        if (audioData == nullptr || length < 64)
-        {
-            return -1.0f;
-        }
+            for (;;)
+            {
+                uint32_t read = g_captureReadIndex.load(std::memory_order_relaxed);
+                uint32_t write = g_captureWriteIndex.load(std::memory_order_acquire);
+                uint32_t available = write - read;
+                if (available == 0)
+                {
+                    break;
+                }
 
-        float rms = calculate_rms(audioData, length);
-        float peak = calculate_peak(audioData, length);
+                // Contiguous part only; the wrapped remainder is the next pass
+                uint32_t start = read & g_captureMask;
+                uint32_t chunk = g_captureCapacity - start;
+                if (chunk > available)
+                    chunk = available;
 
-        if (!noise_gate_check(rms, peak))
-        {
-            return -1.0f;
-        }
+                capture_block_timing(read, &chunk);
+                int produced = stream_push(g_captureRing + start, (int)chunk);
+                g_captureReadIndex.store(read + chunk, std::memory_order_release);
 
-        int halfLen = length / 2;
+                // Deliver only the newest estimate from this chunk
+                TunerResultCallback callback = g_resultCallback.load(std::memory_order_acquire);
+                TunerResult result;
+                if (produced > 0 && callback != nullptr && shared_result_poll(&g_callbackCount, &result))
+                {
+                    callback(result.pitchHz, result.confidence,
+                             result.smoothedPitchHz, result.driftCentsPerSecond);
+                }
+            }
+        }
+    }
 
-        if (!ensure_yin_buffer(halfLen))
+    // ========================================================================
+    // ANALYSIS THREAD: Start
+    // Requires tuner_stream_configure first. capacity <= 0 uses the default;
+    // it is raised to at least one analysis window. Results are read with
+    // tuner_poll, or delivered through tuner_set_result_callback.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) bool tuner_analysis_start(int capacity)
+    {
+        if (g_analysisRunning.load() || g_streamWindow == 0)
         {
-            return -1.0f;
+            return false;
         }
 
-        yin_difference(audioData, g_yinBuffer, length);
-        yin_cumulative_mean_normalized_difference(g_yinBuffer, length);
+        if (capacity <= 0)
+            capacity = CAPTURE_RING_DEFAULT_CAPACITY;
+        if (capacity < g_streamWindow)
+            capacity = g_streamWindow;
+        if (capacity > CAPTURE_RING_MAX_CAPACITY)
+            capacity = CAPTURE_RING_MAX_CAPACITY;
 
-        float confidence = 0.0f;
-        int tau = yin_absolute_threshold(g_yinBuffer, length, sampleRate, &confidence);
+        uint32_t size = 1;
+        while (size < (uint32_t)capacity)
+            size <<= 1;
 
-        if (tau == -1)
+        if (g_captureRing == nullptr || g_captureCapacity != size)
         {
-            return -1.0f;
+            float *ring = (float *)aligned_zeroed_alloc(sizeof(float) * size);
+            if (ring == nullptr)
+            {
+                return false;
+            }
+            free(g_captureRing);
+            g_captureRing = ring;
+            g_captureCapacity = size;
+            g_captureMask = size - 1;
         }
 
-        float betterTau = yin_parabolic_interpolation(g_yinBuffer, tau, length);
-        float pitchHz = (float)sampleRate / betterTau;
-
-        if (pitchHz < g_minFrequency || pitchHz > g_maxFrequency)
+        if (!capture_signal_init(&g_captureSignal))
         {
-            return -1.0f;
+            return false;
         }
 
-        if (outConfidence != nullptr)
+        g_captureWriteIndex.store(0);
+        g_captureReadIndex.store(0);
+        g_captureOverruns.store(0);
+        g_captureStampWrite.store(0);
+        g_captureStampRead = 0;
+        g_callbackCount = g_sharedResult.count;
+        g_analysisRunning.store(true, std::memory_order_release);
+        g_analysisThread = std::thread(analysis_thread_main);
+        return true;
+    }
+
+    // ========================================================================
+    // ANALYSIS THREAD: Register the result callback (nullptr to remove)
+    // With a callback set, estimates are pushed as they are produced and
+    // tuner_poll is not needed. Clear it only after tuner_analysis_stop so
+    // the thread cannot call into a released callback.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_set_result_callback(TunerResultCallback callback)
+    {
+        g_resultCallback.store(callback, std::memory_order_release);
+    }
+
+    // ========================================================================
+    // ANALYSIS THREAD: Stop and join (unanalyzed samples are discarded)
+    // Safe against a producer writing concurrently: writes that started
+    // before the ring closed finish first; later ones are refused.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) void tuner_analysis_stop()
+    {
+        if (!g_analysisRunning.exchange(false))
+        {
+            return;
+        }
+        // Writes are wait-free and short, so this spin is brief
+        while (g_captureWriters.load(std::memory_order_acquire) != 0)
         {
-            *outConfidence = confidence;
+            std::this_thread::yield();
         }
+        capture_signal_post(&g_captureSignal);
+        g_analysisThread.join();
+        capture_signal_destroy(&g_captureSignal);
+    }
 
-        g_lastValidPitch = pitchHz;
-        return pitchHz;
+    // ========================================================================
+    // CAPTURE RING: Samples dropped since start because the ring was full
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) uint32_t tuner_capture_overruns()
+    {
+        return g_captureOverruns.load(std::memory_order_relaxed);
     }
 
     // ========================================================================
     // Get current noise gate state (for UI feedback)
+    // State getters report the last finished frame and are safe on any thread.
     // ========================================================================
     __attribute__((visibility("default"))) __attribute__((used)) bool is_gate_open()
     {
-        return g_gateIsOpen;
+        return g_reportedGateOpen.load(std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Get idle mode state (engine is in low-power listening)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) bool is_idle()
+    {
+        return g_reportedIdle.load(std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Get the governor's quality level (0 = full quality, higher = cheaper)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) int tuner_quality_level()
+    {
+        return g_governorLevel.load();
+    }
+
+    // ========================================================================
+    // Get the smoothed analysis load as a fraction of real time
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float tuner_cpu_load()
+    {
+        return g_governorLoad.load();
+    }
+
+    // ========================================================================
+    // Get whether tuner_prepare managed to lock the scratch memory
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) bool is_memory_locked()
+    {
+        return g_memoryLocked;
+    }
+
+    // ========================================================================
+    // Get tracked mains hum frequency (0 if no hum is being rejected)
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) float get_hum_frequency()
+    {
+        return g_reportedHumFrequency.load(std::memory_order_relaxed);
     }
 
     // ========================================================================
@@ -466,21 +3286,165 @@ extern "C"
     // ========================================================================
     __attribute__((visibility("default"))) __attribute__((used)) void cleanup_pitch_detector()
     {
-        if (g_yinBuffer != nullptr)
+        tuner_analysis_stop();
+        g_resultCallback.store(nullptr);
+        free(g_captureRing);
+        g_captureRing = nullptr;
+        g_captureCapacity = 0;
+        g_captureMask = 0;
+        free(g_inputBuffer);
+        g_inputBuffer = nullptr;
+        g_inputCapacity = 0;
+
+        // All stage scratch goes in one shot with the arena
+        if (g_memoryLocked)
         {
-            free(g_yinBuffer);
-            g_yinBuffer = nullptr;
-            g_yinBufferSize = 0;
+            munlock(g_arenaBase, g_arenaSize);
+            g_memoryLocked = false;
         }
+        free(g_arenaBase);
+        g_arenaBase = nullptr;
+        g_arenaSize = 0;
+        g_arenaSessionEnd = 0;
+        g_arenaUsed = 0;
+        g_arenaMaxLength = 0;
+        g_arenaSampleRate = 0;
+        g_prepared = false;
+
+        g_humInput = nullptr;
+        g_humOutput = nullptr;
+        g_humHistory = 0;
+        g_humActive = false;
+        g_humNominal = 0.0f;
+        g_humFrequency = 0.0f;
+        g_humDetectSamples = 0;
+        g_humMissCounter = 0;
+        g_humHitCounter = 0;
+        g_humRejectionEnabled = true;
+
+        g_ssCos = g_ssSin = g_ssWindow = g_ssRe = g_ssIm = g_ssNoise = nullptr;
+        g_ssBitReverse = nullptr;
+        g_ssLearnedFrames = 0;
+        g_ssLearnSamples = 0;
+        g_denoiserEnabled = false;
+
+        g_streamRaw = g_streamFiltered = nullptr;
+        g_streamWindow = 0;
+        g_streamHop = 0;
+        g_streamSampleRate = 0;
+        g_streamWritePos = 0;
+        g_streamFilled = 0;
+        g_streamSinceHop = 0;
+        g_streamPending = 0;
+        g_streamArrival = 0.0;
+        g_streamEndTime = 0.0;
 
         // Reset state
-        g_gateOpenCounter = 0;
-        g_gateCloseCounter = 0;
+        g_gateOpenSamples = 0;
+        g_gateCloseSamples = 0;
         g_gateIsOpen = false;
         g_lastValidPitch = -1.0f;
+        g_isIdle = false;
+        g_idleSamples = 0;
+        g_onsetEnergyAverage = 0.0f;
+        g_onsetRefractory = 0;
+        g_samplesSinceOnset = -1;
+        g_onsetBlockSum = 0.0f;
+        g_onsetBlockFill = 0;
+        smoothing_reset();
+        state_report();
         g_currentMode = MODE_CHROMATIC;
         g_minFrequency = DEFAULT_MIN_FREQ;
         g_maxFrequency = DEFAULT_MAX_FREQ;
         g_noiseThreshold = NOISE_GATE_CHROMATIC;
+        g_cpuBudget = GOVERNOR_DEFAULT_BUDGET;
+        g_governorLevel.store(0);
+        g_governorLoad.store(0.0f);
+        g_governorOverCount = 0;
+        g_governorUnderCount = 0;
+        g_governorHopsSkipped = 0;
+        g_governorFrameSamples = 0;
+        g_governorLastResult = {-1.0f, 0.0f, -1.0f, 0.0f};
+        // The trail head keeps counting so readers' positions stay valid
+        g_trailReference = 0.0f;
+        g_trailLast = NAN;
+        g_trailDue = 0;
+        g_configPending = CONFIG_DEFAULTS;
+        g_configSlots[0] = g_configSlots[1] = g_configSlots[2] = CONFIG_DEFAULTS;
+        g_configFront = 0;
+        g_configBack = 1;
+        g_configMiddle.store(2);
+    }
+
+    // ========================================================================
+    // TIMING: Current time on the clock TunerTiming stamps use (seconds)
+    // Lets the UI stamp when it showed an estimate against the same clock.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) double tuner_now()
+    {
+        return governor_now();
+    }
+
+    // ========================================================================
+    // API TABLE: Every entry point plus this build's capabilities
+    // ========================================================================
+    static const TunerApi g_api = {
+        TUNER_API_VERSION,
+        TUNER_CAP_SMOOTHING | TUNER_CAP_STREAM | TUNER_CAP_ANALYSIS_THREAD |
+            TUNER_CAP_SHARED_RESULT | TUNER_CAP_GOVERNOR | TUNER_CAP_DENOISER
+#ifdef NOTEFY_RT_AUDIT
+            | TUNER_CAP_RT_AUDIT
+#endif
+        ,
+        detect_pitch,
+        detect_pitch_with_confidence,
+        detect_pitch_smoothed,
+        cleanup_pitch_detector,
+        set_tuning_mode,
+        set_noise_threshold,
+        set_frequency_range,
+        reset_frequency_range,
+        is_gate_open,
+        is_idle,
+        set_hum_rejection,
+        get_hum_frequency,
+        set_spectral_denoiser,
+        tuner_input_buffer,
+        tuner_prepare,
+        is_memory_locked,
+        tuner_memory_footprint,
+        tuner_set_cpu_budget,
+        tuner_quality_level,
+        tuner_cpu_load,
+        tuner_rt_audit,
+        tuner_rt_audit_reset,
+        tuner_stream_configure,
+        tuner_push,
+        tuner_poll,
+        tuner_shared_result,
+        tuner_analysis_start,
+        tuner_analysis_stop,
+        tuner_capture_write,
+        tuner_capture_write_f64,
+        tuner_capture_overruns,
+        tuner_set_result_callback,
+        tuner_trail,
+        tuner_set_trail_reference,
+        tuner_now,
+        tuner_input_buffer_alloc,
+        tuner_input_buffer_free,
+    };
+
+    // ========================================================================
+    // API TABLE: Get the function table for layout `version` (1..current)
+    // Returns nullptr if this library predates the requested version.
+    // ========================================================================
+    __attribute__((visibility("default"))) __attribute__((used)) const TunerApi *tuner_get_api(int version)
+    {
+        if (version < 1 || version > TUNER_API_VERSION)
+        {
+            return nullptr;
+        }
+        return &g_api;
     }
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+/*
+ * CPU budget governor: quality steps down when starved and back up after.
+ *
+ * With an impossibly small budget the governor must drop to a cheaper
+ * level while estimates stay in tune; with a generous budget it must climb
+ * back to full quality. Frames it skips must still follow the gate and
+ * onsets: a stopped note clears once the gate closes, and a new pluck is
+ * reported on its first frame instead of the previous note repeating.
+ *
+ * Analyses are accounted at a simulated load rather than timed, so the
+ * outcome does not depend on the speed of the host or the build type.
+ */
+
+#include "notefy_test.h"
+
+#define BLOCK 512
+
+static int feed(TestSignal *signal, double seconds, double frequency, int *correct)
+{
+    static float block[BLOCK];
+    TunerResult result;
+    int estimates = 0;
+    for (long n = 0; n < (long)(seconds * TEST_SAMPLE_RATE); n += BLOCK)
+    {
+        test_tone(signal, block, BLOCK, frequency, 0.3);
+        tuner_push(block, BLOCK);
+        if (tuner_poll(&result) && result.pitchHz > 0.0f)
+        {
+            estimates++;
+            if (fabsf(cents_off(result.pitchHz, (float)frequency)) < 5.0f)
+                (*correct)++;
+        }
+    }
+    return estimates;
+}
+
+int main()
+{
+    TestSignal signal = {0, 1};
+    int correct = 0;
+
+    // Full quality takes as long as the audio, far over a 0.2% budget
+    cleanup_pitch_detector();
+    tuner_governor_simulate_load(1.0f);
+    tuner_set_cpu_budget(0.002f);
+    CHECK(tuner_stream_configure(8192, 2048, TEST_SAMPLE_RATE), "configure");
+    int estimates = feed(&signal, 2.0, 440.0, &correct);
+    int starved = tuner_quality_level();
+    printf("starved: level %d, %d/%d estimates in tune\n", starved, correct, estimates);
+    CHECK(starved > 0, "level %d under a 0.2%% budget", starved);
+    CHECK(estimates > 0 && correct == estimates, "%d/%d in tune", correct, estimates);
+
+    // A tenth of that, well within a 90% budget
+    tuner_governor_simulate_load(0.1f);
+    tuner_set_cpu_budget(0.9f);
+    correct = 0;
+    feed(&signal, 8.0, 440.0, &correct);
+    printf("relaxed: level %d\n", tuner_quality_level());
+    CHECK(tuner_quality_level() == 0, "level %d after 8 s with headroom", tuner_quality_level());
+
+    // Whole frames at the lowest level, analyzing one frame in four
+    static float frame[TEST_FRAME];
+    cleanup_pitch_detector();
+    tuner_set_cpu_budget(0.00001f);
+    for (int k = 0; k < 40; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, 440.0, 0.3);
+        detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    }
+    CHECK(tuner_quality_level() == 3, "level %d under a starved budget", tuner_quality_level());
+
+    // Silence: cleared when the gate closes (five reference frames)
+    int cleared = -1;
+    for (int k = 0; k < 12; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, 0.0, 0.0);
+        float pitch = detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+        if (pitch < 0.0f && cleared < 0)
+            cleared = k;
+        CHECK(cleared < 0 || pitch < 0.0f, "silent frame %d read as %.2f Hz", k, pitch);
+    }
+    printf("skipping: stopped note cleared after %d silent frames\n", cleared + 1);
+    CHECK(cleared >= 0 && cleared < 6, "stopped note cleared after %d frames", cleared + 1);
+
+    // A quiet A4 re-plucked as a loud D3 early in a frame
+    for (int k = 0; k < 8; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, 440.0, 0.05);
+        detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    }
+    test_tone(&signal, frame, TEST_FRAME, 440.0, 0.05);
+    TestSignal pluck = {0, 3};
+    test_tone(&pluck, frame + 500, TEST_FRAME - 500, 146.83, 0.4);
+    float pitch = detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    printf("skipping: re-pluck read as %.2f Hz\n", pitch);
+    CHECK(pitch > 0.0f && fabsf(cents_off(pitch, 146.83f)) < 5.0f, "re-pluck read as %.2f Hz", pitch);
+
+    tuner_governor_simulate_load(-1.0f);
+    cleanup_pitch_detector();
+    return test_result();
+}
@@ -0,0 +1,131 @@
+/*
+ * Shared helpers for the native tuner tests.
+ *
+ * notefy.cpp has no public header, so the entry points the tests call are
+ * declared here (keep in sync with the extern "C" block). Signals are
+ * synthesized with a fixed-seed generator so every run sees the same audio.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+extern "C"
+{
+    typedef struct
+    {
+        float pitchHz;
+        float confidence;
+        float smoothedPitchHz;
+        float driftCentsPerSecond;
+    } TunerResult;
+
+    typedef void (*TunerResultCallback)(float pitchHz, float confidence, float smoothedPitchHz,
+                                        float driftCentsPerSecond);
+
+    float detect_pitch(float *audioData, int length, int sampleRate);
+    float detect_pitch_with_confidence(float *audioData, int length, int sampleRate, float *outConfidence);
+    float detect_pitch_smoothed(float *audioData, int length, int sampleRate, TunerResult *outResult);
+    void cleanup_pitch_detector();
+    void set_tuning_mode(int mode);
+    void set_hum_rejection(bool enabled);
+    void set_spectral_denoiser(bool enabled);
+    bool is_gate_open();
+    bool is_idle();
+    float get_hum_frequency();
+    bool tuner_prepare(int maxLength, int sampleRate, bool lockMemory);
+    void tuner_set_cpu_budget(float budget);
+    int tuner_quality_level();
+    void tuner_governor_simulate_load(float load);
+    bool tuner_stream_configure(int windowSize, int hopSize, int sampleRate);
+    int tuner_push(const float *samples, int n);
+    bool tuner_poll(TunerResult *outResult);
+    bool tuner_analysis_start(int capacity);
+    void tuner_analysis_stop();
+    int tuner_capture_write(const float *samples, int n);
+    void tuner_set_result_callback(TunerResultCallback callback);
+
+    typedef struct
+    {
+        uint32_t head;
+        uint32_t capacity;
+        float cents[4096];
+    } TunerTrail;
+
+    const TunerTrail *tuner_trail();
+    void tuner_set_trail_reference(float referenceHz);
+}
+
+#define TEST_SAMPLE_RATE 44100
+#define TEST_FRAME 8192
+
+static int g_testFailures = 0;
+
+// Record a failure and keep going, so one run reports every broken check
+#define CHECK(condition, ...)                                                   \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, \
+                    #condition);                                                \
+            fprintf(stderr, __VA_ARGS__);                                       \
+            fputc('\n', stderr);                                                \
+            g_testFailures++;                                                   \
+        }                                                                       \
+    } while (0)
+
+static inline int test_result()
+{
+    if (g_testFailures == 0)
+        puts("OK");
+    return g_testFailures == 0 ? 0 : 1;
+}
+
+static inline float cents_off(float pitchHz, float expectedHz)
+{
+    return 1200.0f * log2f(pitchHz / expectedHz);
+}
+
+// Uniform noise in [-1, 1) from a fixed-seed LCG (libc rand() varies)
+static inline float test_noise(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 8388608.0f - 1.0f;
+}
+
+// Continuous signal source: harmonic tone + mains hum + noise. The sample
+// position carries across blocks so consecutive frames join seamlessly.
+typedef struct
+{
+    long position;
+    uint32_t noiseState;
+} TestSignal;
+
+static inline void test_tone(TestSignal *signal, float *out, int n, double frequency, double amplitude,
+                             double hum = 0.0, double humFrequency = 50.0, double noise = 0.0)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double t = (double)(signal->position + i) / TEST_SAMPLE_RATE;
+        double x = 0.0;
+        if (frequency > 0.0)
+        {
+            x += amplitude * (sin(2.0 * M_PI * frequency * t) + 0.5 * sin(4.0 * M_PI * frequency * t) +
+                              0.3 * sin(6.0 * M_PI * frequency * t));
+        }
+        if (hum > 0.0)
+        {
+            x += hum * (sin(2.0 * M_PI * humFrequency * t) + 0.6 * sin(4.0 * M_PI * humFrequency * t) +
+                        0.4 * sin(6.0 * M_PI * humFrequency * t));
+        }
+        if (noise > 0.0)
+        {
+            x += noise * test_noise(&signal->noiseState);
+        }
+        out[i] = (float)x;
+    }
+    signal->position += n;
+}
@@ -0,0 +1,79 @@
+/*
+ * Onset detection: a pluck from silence, then a re-pluck over the decay.
+ *
+ * The gate normally needs two loud frames to open. An attack detected
+ * inside a frame opens it at once, so the first estimate must arrive on
+ * the frame that contains the pluck, and a new note plucked over a ringing
+ * one must be reported on its first frame too. Streaming hops that do not
+ * divide into onset blocks must not hide attacks.
+ */
+
+#include "notefy_test.h"
+
+static void pluck(float *out, long start, int n, long onset, double frequency, double amplitude)
+{
+    for (int i = 0; i < n; i++)
+    {
+        long g = start + i;
+        if (g < onset)
+            continue;
+        double t = (double)(g - onset) / TEST_SAMPLE_RATE;
+        out[i] += (float)(amplitude * exp(-t * 1.5) *
+                          (sin(2.0 * M_PI * frequency * t) + 0.6 * sin(4.0 * M_PI * frequency * t)));
+        if (t < 0.01) // Pick noise
+            out[i] += (float)(0.5 * sin(g * 1.3) * (1.0 - t / 0.01));
+    }
+}
+
+int main()
+{
+    static float frame[TEST_FRAME];
+    const long firstOnset = 3L * TEST_FRAME + 1500;  // A2 plucked mid-frame 3
+    const long secondOnset = 10L * TEST_FRAME + 500; // D3 plucked early in frame 10
+
+    cleanup_pitch_detector();
+    for (int k = 0; k < 16; k++)
+    {
+        long start = (long)k * TEST_FRAME;
+        for (int i = 0; i < TEST_FRAME; i++)
+            frame[i] = 0.0f;
+        pluck(frame, start, TEST_FRAME, firstOnset, 110.0, k < 10 ? 0.4 : 0.05);
+        pluck(frame, start, TEST_FRAME, secondOnset, 146.83, 0.4);
+
+        float pitch = detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+        printf("frame %2d: %.2f Hz\n", k, pitch);
+        if (k < 3)
+            CHECK(pitch < 0.0f, "silent frame %d read as %.2f Hz", k, pitch);
+        else if (k < 10)
+            CHECK(pitch > 0.0f && fabsf(cents_off(pitch, 110.0f)) < 5.0f, "frame %d: %.2f Hz, want A2", k, pitch);
+        else
+            CHECK(pitch > 0.0f && fabsf(cents_off(pitch, 146.83f)) < 5.0f, "frame %d: %.2f Hz, want D3", k, pitch);
+    }
+
+    // Streaming with a hop that is not a whole number of onset blocks (and
+    // shorter than one): the attack must still be found, so the first
+    // estimate comes from the onset path rather than the gate's attack
+    // hysteresis (two reference frames of loud audio)
+    const int hop = 200;
+    const long onset = 3L * TEST_FRAME + 130; // Well after the window has filled
+    cleanup_pitch_detector();
+    CHECK(tuner_stream_configure(TEST_FRAME, hop, TEST_SAMPLE_RATE), "configure");
+    long firstEstimate = -1;
+    for (long start = 0; start < 8L * TEST_FRAME && firstEstimate < 0; start += hop)
+    {
+        for (int i = 0; i < hop; i++)
+            frame[i] = 0.0f;
+        pluck(frame, start, hop, onset, 110.0, 0.4);
+        tuner_push(frame, hop);
+        TunerResult result;
+        if (tuner_poll(&result) && result.pitchHz > 0.0f)
+        {
+            CHECK(fabsf(cents_off(result.pitchHz, 110.0f)) < 5.0f, "stream estimate %.2f Hz", result.pitchHz);
+            firstEstimate = start + hop;
+        }
+    }
+    printf("hop %d: first estimate %ld samples after the pluck\n", hop, firstEstimate - onset);
+    CHECK(firstEstimate > 0 && firstEstimate - onset < TEST_FRAME, "first estimate %ld samples after the pluck",
+          firstEstimate - onset);
+    return test_result();
+}
@@ -0,0 +1,115 @@
+/*
+ * Real-time audit (NOTEFY_RT_AUDIT builds only).
+ *
+ * After tuner_prepare, processing a frame must not allocate, free or take
+ * a mutex on any path: whole frames through detect_pitch*, pushed blocks
+ * through the stream, and the capture-ring worker. The last two run with
+ * trapping on, so a violation aborts the test. A frame on an unprepared
+ * engine must be caught, which shows the audit is actually counting and
+ * that trap mode fires.
+ */
+
+#include "notefy_test.h"
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern "C"
+{
+    typedef struct
+    {
+        uint32_t frames;
+        uint32_t allocations;
+        uint32_t frees;
+        uint32_t locks;
+    } TunerRtAudit;
+
+    bool tuner_rt_audit(TunerRtAudit *outAudit);
+    void tuner_rt_audit_reset(bool trap);
+}
+
+#define BLOCK 441
+
+static void expect_clean(const char *label, uint32_t minFrames)
+{
+    TunerRtAudit audit;
+    CHECK(tuner_rt_audit(&audit), "%s: library is not an audit build", label);
+    printf("%-14s frames=%u allocations=%u frees=%u locks=%u\n", label, audit.frames, audit.allocations,
+           audit.frees, audit.locks);
+    CHECK(audit.frames >= minFrames, "%s: %u frames audited", label, audit.frames);
+    CHECK(audit.allocations == 0 && audit.frees == 0 && audit.locks == 0, "%s: not real-time safe", label);
+}
+
+int main()
+{
+    static float frame[TEST_FRAME];
+    static float block[BLOCK];
+    TestSignal signal = {0, 1};
+
+    // Unprepared: the first frame creates the arena, which the audit sees
+    cleanup_pitch_detector();
+    tuner_rt_audit_reset(false);
+    test_tone(&signal, frame, TEST_FRAME, 220.0, 0.3);
+    detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    TunerRtAudit audit;
+    tuner_rt_audit(&audit);
+    CHECK(audit.allocations > 0, "lazy arena creation went unnoticed");
+
+    // ... and with trapping on it aborts the process
+    pid_t child = fork();
+    if (child == 0)
+    {
+        cleanup_pitch_detector();
+        tuner_rt_audit_reset(true);
+        detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT, "trap mode did not abort (status %d)", status);
+
+    // Prepared whole frames, with every optional stage running
+    cleanup_pitch_detector();
+    CHECK(tuner_prepare(TEST_FRAME, TEST_SAMPLE_RATE, false), "prepare");
+    set_spectral_denoiser(true);
+    tuner_rt_audit_reset(false);
+    TunerResult result;
+    for (int k = 0; k < 40; k++)
+    {
+        // Noise first so the denoiser learns, then a note over mains hum
+        if (k < 10)
+            test_tone(&signal, frame, TEST_FRAME, 0.0, 0.0, 0.0, 50.0, 0.004);
+        else
+            test_tone(&signal, frame, TEST_FRAME, 110.0, 0.3, 0.03, 50.0, 0.004);
+        detect_pitch_smoothed(frame, TEST_FRAME, TEST_SAMPLE_RATE, &result);
+    }
+    expect_clean("detect_pitch", 40);
+
+    // Pushed blocks, trapping
+    CHECK(tuner_stream_configure(TEST_FRAME, 2048, TEST_SAMPLE_RATE), "configure");
+    tuner_rt_audit_reset(true);
+    for (int k = 0; k < 400; k++)
+    {
+        test_tone(&signal, block, BLOCK, 146.83, 0.3, 0.03);
+        tuner_push(block, BLOCK);
+        tuner_poll(&result);
+    }
+    expect_clean("tuner_push", 400);
+
+    // Capture-ring worker, trapping
+    CHECK(tuner_analysis_start(0), "analysis start");
+    tuner_rt_audit_reset(true);
+    for (int k = 0; k < 200; k++)
+    {
+        test_tone(&signal, block, BLOCK, 196.0, 0.3, 0.03);
+        tuner_capture_write(block, BLOCK);
+        usleep(2000);
+    }
+    usleep(50000);
+    tuner_analysis_stop();
+    expect_clean("worker", 100);
+
+    tuner_rt_audit_reset(false);
+    cleanup_pitch_detector();
+    return test_result();
+}
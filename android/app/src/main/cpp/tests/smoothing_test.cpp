@@ -0,0 +1,57 @@
+/*
+ * Native smoothing: median outlier gate + Kalman position/drift filter.
+ *
+ * A slow 10 cents/second glide must be tracked without lag and its drift
+ * rate reported; a jump to a new note must restart the filter rather than
+ * slew towards it.
+ */
+
+#include "notefy_test.h"
+
+int main()
+{
+    static float frame[TEST_FRAME];
+    const double glideCentsPerSecond = 10.0;
+    double phase = 0.0;
+    long position = 0;
+    uint32_t noiseState = 1;
+    TunerResult result;
+
+    cleanup_pitch_detector();
+    for (int k = 0; k < 20; k++)
+    {
+        for (int i = 0; i < TEST_FRAME; i++)
+        {
+            double t = (double)(position + i) / TEST_SAMPLE_RATE;
+            double frequency = 110.0 * pow(2.0, glideCentsPerSecond * t / 1200.0);
+            phase += 2.0 * M_PI * frequency / TEST_SAMPLE_RATE;
+            frame[i] = (float)(0.3 * sin(phase) + 0.15 * sin(2.0 * phase) + 0.01 * test_noise(&noiseState));
+        }
+        position += TEST_FRAME;
+        detect_pitch_smoothed(frame, TEST_FRAME, TEST_SAMPLE_RATE, &result);
+
+        // Estimates describe the middle of the frame
+        double middle = (position - TEST_FRAME / 2) / (double)TEST_SAMPLE_RATE;
+        float expected = (float)(110.0 * pow(2.0, glideCentsPerSecond * middle / 1200.0));
+        if (k < 8)
+            continue; // Filter settling
+        CHECK(result.smoothedPitchHz > 0.0f && fabsf(cents_off(result.smoothedPitchHz, expected)) < 1.5f,
+              "frame %d smoothed %.3f Hz, want %.3f Hz", k, result.smoothedPitchHz, expected);
+        CHECK(fabsf(result.driftCentsPerSecond - (float)glideCentsPerSecond) < 2.0f, "frame %d drift %.2f c/s",
+              k, result.driftCentsPerSecond);
+    }
+
+    // Jump a fifth up without an attack: the median treats the first new
+    // estimates as outliers, and the filter restarts once they are the
+    // majority (third frame with a five-entry median)
+    TestSignal signal = {position, 1};
+    for (int k = 0; k < 3; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, 164.81, 0.3);
+        detect_pitch_smoothed(frame, TEST_FRAME, TEST_SAMPLE_RATE, &result);
+    }
+    printf("after jump: raw %.3f Hz smoothed %.3f Hz\n", result.pitchHz, result.smoothedPitchHz);
+    CHECK(fabsf(cents_off(result.smoothedPitchHz, 164.81f)) < 2.0f, "smoothed %.3f Hz after the jump",
+          result.smoothedPitchHz);
+    return test_result();
+}
@@ -0,0 +1,132 @@
+/*
+ * Streaming: push/poll on the caller's thread and the capture-ring worker.
+ *
+ * Small capture blocks must yield one estimate per hop once a window is
+ * buffered, and the worker must deliver the same pitch from audio written
+ * into the capture ring, undisturbed by direct calls made meanwhile. A
+ * result callback and tuner_poll must not take each other's estimates.
+ * Stopping the worker must be safe while a capture callback is still
+ * writing.
+ */
+
+#include "notefy_test.h"
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+
+#define BLOCK 441 // 10 ms capture buffer
+
+int main()
+{
+    static float block[BLOCK];
+    const int window = 8192;
+    const int hop = 2048;
+    TestSignal signal = {0, 1};
+    TunerResult result;
+
+    // Push/poll: 2 s of A3 in 10 ms blocks. The governor is off so that
+    // every hop is analyzed however slow the build.
+    cleanup_pitch_detector();
+    tuner_set_cpu_budget(0.0f);
+    CHECK(tuner_stream_configure(window, hop, TEST_SAMPLE_RATE), "configure");
+    int produced = 0;
+    int correct = 0;
+    for (int k = 0; k < 200; k++)
+    {
+        test_tone(&signal, block, BLOCK, 220.0, 0.3);
+        produced += tuner_push(block, BLOCK);
+        if (tuner_poll(&result) && result.pitchHz > 0.0f && fabsf(cents_off(result.pitchHz, 220.0f)) < 2.0f)
+            correct++;
+    }
+    int expected = (200 * BLOCK - window) / hop + 1;
+    printf("push: %d estimates (%d expected), %d correct\n", produced, expected, correct);
+    CHECK(produced >= expected - 1 && produced <= expected, "%d estimates", produced);
+    CHECK(correct >= produced - 3, "%d of %d correct", correct, produced);
+
+    // Worker: the same through the capture ring, paced like a capture callback
+    cleanup_pitch_detector();
+    CHECK(tuner_stream_configure(window, hop, TEST_SAMPLE_RATE), "configure");
+    CHECK(tuner_analysis_start(0), "analysis start");
+    int polled = 0;
+    correct = 0;
+    static float frame[TEST_FRAME];
+    TestSignal other = {0, 2};
+    for (int k = 0; k < 200; k++)
+    {
+        test_tone(&signal, block, BLOCK, 146.83, 0.3);
+        CHECK(tuner_capture_write(block, BLOCK) == BLOCK, "capture write %d", k);
+
+        // The worker owns the engine: direct calls get nothing and change nothing
+        if (k % 20 == 10)
+        {
+            test_tone(&other, frame, TEST_FRAME, 440.0, 0.3);
+            CHECK(detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE) < 0.0f, "detect_pitch ran beside the worker");
+            CHECK(tuner_push(block, BLOCK) == 0, "tuner_push ran beside the worker");
+        }
+        usleep(10000);
+        if (tuner_poll(&result))
+        {
+            polled++;
+            if (result.pitchHz > 0.0f && fabsf(cents_off(result.pitchHz, 146.83f)) < 2.0f)
+                correct++;
+        }
+    }
+    usleep(50000);
+    CHECK(is_gate_open() && !is_idle(), "gate %d idle %d during a note", is_gate_open(), is_idle());
+    tuner_analysis_stop();
+    printf("worker: %d polled, %d correct\n", polled, correct);
+    CHECK(polled > 0 && correct >= polled - 3, "%d of %d correct", correct, polled);
+
+    // Worker with a result callback while the caller also polls
+    static std::atomic<int> delivered(0);
+    cleanup_pitch_detector();
+    tuner_set_cpu_budget(0.0f);
+    CHECK(tuner_stream_configure(window, hop, TEST_SAMPLE_RATE), "configure");
+    tuner_set_result_callback([](float, float, float, float) { delivered++; });
+    CHECK(tuner_analysis_start(0), "analysis start");
+    polled = 0;
+    for (int k = 0; k < 200; k++)
+    {
+        test_tone(&signal, block, BLOCK, 146.83, 0.3);
+        tuner_capture_write(block, BLOCK);
+        usleep(10000);
+        if (tuner_poll(&result))
+            polled++;
+    }
+    usleep(50000);
+    tuner_analysis_stop();
+    tuner_set_result_callback(nullptr);
+    // A slow build drains several hops per wakeup and the callback gets
+    // only the newest, so the counts vary; neither reader may starve
+    printf("callback: %d delivered, %d polled, %d estimates\n", delivered.load(), polled, expected);
+    CHECK(delivered.load() > 0 && polled > 0, "callback saw %d, tuner_poll saw %d", delivered.load(), polled);
+
+    // Start/stop cycles against a producer that never pauses
+    std::atomic<bool> producing(true);
+    std::atomic<long> accepted(0);
+    std::thread producer([&]() {
+        static float samples[BLOCK];
+        TestSignal source = {0, 1};
+        while (producing.load())
+        {
+            test_tone(&source, samples, BLOCK, 110.0, 0.3);
+            accepted += tuner_capture_write(samples, BLOCK);
+        }
+    });
+    int cycles = 0;
+    for (int k = 0; k < 200; k++)
+    {
+        if (tuner_analysis_start(0))
+            cycles++;
+        usleep(200);
+        tuner_analysis_stop();
+    }
+    producing.store(false);
+    producer.join();
+    printf("start/stop: %d cycles, %ld samples accepted\n", cycles, accepted.load());
+    CHECK(cycles == 200, "%d of 200 starts succeeded", cycles);
+    CHECK(tuner_capture_write(block, BLOCK) == 0, "write accepted after stop");
+
+    cleanup_pitch_detector();
+    return test_result();
+}
@@ -0,0 +1,76 @@
+/*
+ * Trail history: evenly timed entries whatever the frame or hop size.
+ *
+ * Whole frames and small streaming hops must both write 60 entries per
+ * second of audio, so the UI's fixed point count always spans the same
+ * time. Entries ramp between estimates, read as cents from the reference,
+ * and silence is recorded as NaN for the UI's standby to draw.
+ */
+
+#include "notefy_test.h"
+#include <stdlib.h>
+
+#define ENTRY_RATE 60
+
+static float newest(const TunerTrail *trail, uint32_t age)
+{
+    return trail->cents[(trail->head - 1 - age) & (trail->capacity - 1)];
+}
+
+int main()
+{
+    static float frame[TEST_FRAME];
+    const TunerTrail *trail = tuner_trail();
+    TestSignal signal = {0, 1};
+
+    // Whole frames: 4 s of A3 ten cents sharp against an A3 reference
+    cleanup_pitch_detector();
+    tuner_set_cpu_budget(0.0f);
+    tuner_set_trail_reference(220.0f);
+    const double sharp = 220.0 * pow(2.0, 10.0 / 1200.0);
+    uint32_t start = trail->head;
+    int frames = 4 * TEST_SAMPLE_RATE / TEST_FRAME;
+    for (int k = 0; k < frames; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, sharp, 0.3);
+        detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    }
+    uint32_t written = trail->head - start;
+    int expected = (int)((long)frames * TEST_FRAME * ENTRY_RATE / TEST_SAMPLE_RATE);
+    printf("frames: %u entries for %d expected\n", written, expected);
+    CHECK((int)written == expected, "%u entries for %d frames", written, frames);
+    CHECK(fabsf(newest(trail, 0) - 10.0f) < 1.0f, "newest entry %.2f cents", newest(trail, 0));
+
+    // Silence is NaN once the gate has closed
+    for (int k = 0; k < 8; k++)
+    {
+        test_tone(&signal, frame, TEST_FRAME, 0.0, 0.0);
+        detect_pitch(frame, TEST_FRAME, TEST_SAMPLE_RATE);
+    }
+    CHECK(isnan(newest(trail, 0)), "silent entry %.2f", newest(trail, 0));
+
+    // Streaming in 512-sample hops: same rate, and the pitched entries
+    // ramp without gaps
+    cleanup_pitch_detector();
+    tuner_set_cpu_budget(0.0f);
+    CHECK(tuner_stream_configure(TEST_FRAME, 512, TEST_SAMPLE_RATE), "configure");
+    start = trail->head;
+    long pushed = 0;
+    while (pushed < 4L * TEST_SAMPLE_RATE)
+    {
+        test_tone(&signal, frame, 512, 330.0, 0.3);
+        tuner_push(frame, 512);
+        pushed += 512;
+    }
+    written = trail->head - start;
+    expected = (int)(pushed * ENTRY_RATE / TEST_SAMPLE_RATE); // The first estimate covers the whole window
+    printf("stream: %u entries for %d expected\n", written, expected);
+    CHECK(abs((int)written - expected) <= 1, "%u entries for %ld samples", written, pushed);
+    int gaps = 0;
+    for (uint32_t age = 0; age < 60; age++)
+        gaps += isnan(newest(trail, age));
+    CHECK(gaps == 0, "%d silent entries during a note", gaps);
+
+    cleanup_pitch_detector();
+    return test_result();
+}
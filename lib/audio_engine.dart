@@ -1,5 +1,7 @@
+import 'dart:async';
 import 'dart:ffi' as ffi;
 import 'dart:io';
+import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
@@ -24,6 +26,22 @@ typedef NativeDetectPitchWithConfidence =
 typedef DartDetectPitchWithConfidence =
     double Function(ffi.Pointer<ffi.Float>, int, int, ffi.Pointer<ffi.Float>);
 
+// Pitch detection with native smoothing (fills a TunerResult)
+typedef NativeDetectPitchSmoothed =
+    ffi.Float Function(
+      ffi.Pointer<ffi.Float>,
+      ffi.Int32,
+      ffi.Int32,
+      ffi.Pointer<NativeTunerResult>,
+    );
+typedef DartDetectPitchSmoothed =
+    double Function(
+      ffi.Pointer<ffi.Float>,
+      int,
+      int,
+      ffi.Pointer<NativeTunerResult>,
+    );
+
 // Cleanup function
 typedef NativeCleanup = ffi.Void Function();
 typedef DartCleanup = void Function();
@@ -48,6 +66,120 @@ typedef DartResetFrequencyRange = void Function();
 typedef NativeIsGateOpen = ffi.Bool Function();
 typedef DartIsGateOpen = bool Function();
 
+// Check if the engine is in low-power idle mode
+typedef NativeIsIdle = ffi.Bool Function();
+typedef DartIsIdle = bool Function();
+
+// Enable/disable mains hum rejection
+typedef NativeSetHumRejection = ffi.Void Function(ffi.Bool);
+typedef DartSetHumRejection = void Function(bool);
+
+// Tracked mains hum frequency (0 if none)
+typedef NativeGetHumFrequency = ffi.Float Function();
+typedef DartGetHumFrequency = double Function();
+
+// Enable/disable the spectral subtraction denoiser
+typedef NativeSetSpectralDenoiser = ffi.Void Function(ffi.Bool);
+typedef DartSetSpectralDenoiser = void Function(bool);
+
+// Shared input buffer (table version 1 slot; superseded by the per-caller
+// tuner_input_buffer_alloc below, which this binding uses)
+typedef NativeInputBuffer = ffi.Pointer<ffi.Float> Function(ffi.Int32);
+
+// Per-caller input buffer of the given sample count, and its release
+typedef NativeInputBufferAlloc = ffi.Pointer<ffi.Float> Function(ffi.Int32);
+typedef DartInputBufferAlloc = ffi.Pointer<ffi.Float> Function(int);
+typedef NativeInputBufferFree = ffi.Void Function(ffi.Pointer<ffi.Float>);
+typedef DartInputBufferFree = void Function(ffi.Pointer<ffi.Float>);
+
+// Preallocate aligned, pre-faulted (optionally locked) scratch memory
+typedef NativePrepare = ffi.Bool Function(ffi.Int32, ffi.Int32, ffi.Bool);
+typedef DartPrepare = bool Function(int, int, bool);
+
+// Whether the prepared scratch memory is locked in RAM
+typedef NativeIsMemoryLocked = ffi.Bool Function();
+typedef DartIsMemoryLocked = bool Function();
+
+// Exact native scratch footprint in bytes
+typedef NativeMemoryFootprint = ffi.Size Function();
+typedef DartMemoryFootprint = int Function();
+
+// CPU budget governor: budget setter, quality level and measured load
+typedef NativeSetCpuBudget = ffi.Void Function(ffi.Float);
+typedef DartSetCpuBudget = void Function(double);
+
+typedef NativeQualityLevel = ffi.Int32 Function();
+typedef DartQualityLevel = int Function();
+
+typedef NativeCpuLoad = ffi.Float Function();
+typedef DartCpuLoad = double Function();
+
+// Real-time audit counters (only filled in by an audit build)
+typedef NativeRtAudit = ffi.Bool Function(ffi.Pointer<NativeTunerRtAudit>);
+typedef DartRtAudit = bool Function(ffi.Pointer<NativeTunerRtAudit>);
+
+typedef NativeRtAuditReset = ffi.Void Function(ffi.Bool);
+typedef DartRtAuditReset = void Function(bool);
+
+// Streaming API: configure window/hop, push samples, poll latest estimate
+typedef NativeStreamConfigure =
+    ffi.Bool Function(ffi.Int32, ffi.Int32, ffi.Int32);
+typedef DartStreamConfigure = bool Function(int, int, int);
+
+typedef NativeStreamPush =
+    ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32);
+typedef DartStreamPush = int Function(ffi.Pointer<ffi.Float>, int);
+
+typedef NativeStreamPoll = ffi.Bool Function(ffi.Pointer<NativeTunerResult>);
+typedef DartStreamPoll = bool Function(ffi.Pointer<NativeTunerResult>);
+
+// Native analysis thread fed by a lock-free capture ring
+typedef NativeAnalysisStart = ffi.Bool Function(ffi.Int32);
+typedef DartAnalysisStart = bool Function(int);
+
+typedef NativeAnalysisStop = ffi.Void Function();
+typedef DartAnalysisStop = void Function();
+
+typedef NativeCaptureWrite =
+    ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32);
+typedef DartCaptureWrite = int Function(ffi.Pointer<ffi.Float>, int);
+
+// Same ring, double input converted natively (e.g. a Float64List)
+typedef NativeCaptureWriteF64 =
+    ffi.Int32 Function(ffi.Pointer<ffi.Double>, ffi.Int32);
+typedef DartCaptureWriteF64 = int Function(ffi.Pointer<ffi.Double>, int);
+
+typedef NativeCaptureOverruns = ffi.Uint32 Function();
+typedef DartCaptureOverruns = int Function();
+
+// Address of the seqlock-guarded shared result block
+typedef NativeSharedResult =
+    ffi.Pointer<NativeTunerSharedResult> Function();
+typedef DartSharedResult = ffi.Pointer<NativeTunerSharedResult> Function();
+
+// Result callback invoked on the native analysis thread
+typedef NativeResultCallback =
+    ffi.Void Function(ffi.Float, ffi.Float, ffi.Float, ffi.Float);
+typedef NativeSetResultCallback =
+    ffi.Void Function(ffi.Pointer<ffi.NativeFunction<NativeResultCallback>>);
+typedef DartSetResultCallback =
+    void Function(ffi.Pointer<ffi.NativeFunction<NativeResultCallback>>);
+
+// Displayed-cents trail ring and the pitch it is relative to
+typedef NativeTrail = ffi.Pointer<NativeTunerTrail> Function();
+typedef DartTrail = ffi.Pointer<NativeTunerTrail> Function();
+
+typedef NativeSetTrailReference = ffi.Void Function(ffi.Float);
+typedef DartSetTrailReference = void Function(double);
+
+// Engine monotonic clock (seconds), the one result timestamps are taken on
+typedef NativeNow = ffi.Double Function();
+typedef DartNow = double Function();
+
+// Versioned function table (one lookup binds every entry point)
+typedef NativeGetApi = ffi.Pointer<NativeTunerApi> Function(ffi.Int32);
+typedef DartGetApi = ffi.Pointer<NativeTunerApi> Function(int);
+
 // ============================================================================
 // Tuning Mode Constants (must match C++ definitions)
 // ============================================================================
@@ -61,6 +193,215 @@ enum TuningModeNative {
   const TuningModeNative(this.value);
 }
 
+// ============================================================================
+// Native Result Struct (must match TunerResult in notefy.cpp)
+// ============================================================================
+
+final class NativeTunerResult extends ffi.Struct {
+  @ffi.Float()
+  external double pitchHz;
+
+  @ffi.Float()
+  external double confidence;
+
+  @ffi.Float()
+  external double smoothedPitchHz;
+
+  @ffi.Float()
+  external double driftCentsPerSecond;
+}
+
+// ============================================================================
+// Native Result Timing (must match TunerTiming in notefy.cpp)
+// ============================================================================
+
+final class NativeTunerTiming extends ffi.Struct {
+  @ffi.Double()
+  external double audioTime; // Capture time of the window centre
+
+  @ffi.Double()
+  external double blockArrival;
+
+  @ffi.Double()
+  external double analysisStart;
+
+  @ffi.Double()
+  external double analysisEnd;
+}
+
+// ============================================================================
+// Native Shared Result Block (must match TunerSharedResult in notefy.cpp)
+// ============================================================================
+
+final class NativeTunerSharedResult extends ffi.Struct {
+  @ffi.Uint32()
+  external int sequence; // Odd while the engine is writing
+
+  @ffi.Uint32()
+  external int count;
+
+  @ffi.Float()
+  external double pitchHz;
+
+  @ffi.Float()
+  external double confidence;
+
+  @ffi.Float()
+  external double smoothedPitchHz;
+
+  @ffi.Float()
+  external double driftCentsPerSecond;
+
+  @ffi.Float()
+  external double humFrequency;
+
+  @ffi.Uint32()
+  external int gateOpen;
+
+  @ffi.Uint32()
+  external int idle;
+
+  @ffi.Uint32()
+  external int qualityLevel;
+
+  external NativeTunerTiming timing; // API version 3 and later
+}
+
+// ============================================================================
+// Native Real-Time Audit Counters (must match TunerRtAudit in notefy.cpp)
+// ============================================================================
+
+final class NativeTunerRtAudit extends ffi.Struct {
+  @ffi.Uint32()
+  external int frames;
+
+  @ffi.Uint32()
+  external int allocations;
+
+  @ffi.Uint32()
+  external int frees;
+
+  @ffi.Uint32()
+  external int locks;
+}
+
+// ============================================================================
+// Native Trail Ring (must match TunerTrail in notefy.cpp)
+// ============================================================================
+
+const int kTunerTrailCapacity = 4096; // TRAIL_CAPACITY
+const int kTrailEntriesPerSecond = 60; // TRAIL_ENTRY_RATE, per second of audio
+
+final class NativeTunerTrail extends ffi.Struct {
+  @ffi.Uint32()
+  external int head; // Entries written so far; only grows
+
+  @ffi.Uint32()
+  external int capacity;
+
+  @ffi.Array(kTunerTrailCapacity)
+  external ffi.Array<ffi.Float> cents;
+}
+
+// ============================================================================
+// Native API Table (must match TunerApi in notefy.cpp)
+// ============================================================================
+
+// Layout version this binding was written against (TUNER_API_VERSION)
+const int kTunerApiVersion = 4;
+
+// Capability bits (TUNER_CAP_* in notefy.cpp)
+const int kTunerCapRtAudit = 1 << 6;
+
+final class NativeTunerApi extends ffi.Struct {
+  @ffi.Uint32()
+  external int version;
+
+  @ffi.Uint32()
+  external int capabilities;
+
+  // Version 1
+  external ffi.Pointer<ffi.NativeFunction<NativeDetectPitch>> detectPitch;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeDetectPitchWithConfidence>> detectPitchWithConfidence;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeDetectPitchSmoothed>> detectPitchSmoothed;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeCleanup>> cleanup;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetTuningMode>> setTuningMode;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetNoiseThreshold>> setNoiseThreshold;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetFrequencyRange>> setFrequencyRange;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeResetFrequencyRange>> resetFrequencyRange;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeIsGateOpen>> isGateOpen;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeIsIdle>> isIdle;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetHumRejection>> setHumRejection;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeGetHumFrequency>> getHumFrequency;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetSpectralDenoiser>> setSpectralDenoiser;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeInputBuffer>> inputBuffer;
+
+  external ffi.Pointer<ffi.NativeFunction<NativePrepare>> prepare;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeIsMemoryLocked>> isMemoryLocked;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeMemoryFootprint>> memoryFootprint;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetCpuBudget>> setCpuBudget;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeQualityLevel>> qualityLevel;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeCpuLoad>> cpuLoad;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeRtAudit>> rtAudit;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeRtAuditReset>> rtAuditReset;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeStreamConfigure>> streamConfigure;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeStreamPush>> streamPush;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeStreamPoll>> streamPoll;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSharedResult>> sharedResult;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeAnalysisStart>> analysisStart;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeAnalysisStop>> analysisStop;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeCaptureWrite>> captureWrite;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeCaptureWriteF64>> captureWriteF64;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeCaptureOverruns>> captureOverruns;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetResultCallback>> setResultCallback;
+
+  // Version 2
+  external ffi.Pointer<ffi.NativeFunction<NativeTrail>> trail;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeSetTrailReference>>
+  setTrailReference;
+
+  // Version 3
+  external ffi.Pointer<ffi.NativeFunction<NativeNow>> now;
+
+  // Version 4
+  external ffi.Pointer<ffi.NativeFunction<NativeInputBufferAlloc>>
+  inputBufferAlloc;
+
+  external ffi.Pointer<ffi.NativeFunction<NativeInputBufferFree>>
+  inputBufferFree;
+}
+
 // ============================================================================
 // Pitch Detection Result
 // ============================================================================
@@ -68,8 +409,15 @@ enum TuningModeNative {
 class PitchResult {
   final double frequency; // Frequency in Hz (-1 if no pitch detected)
   final double confidence; // Confidence level 0.0 to 1.0
+  final double smoothedFrequency; // Median + Kalman smoothed frequency (-1 if none)
+  final double driftCentsPerSecond; // Rate of change of the smoothed pitch
 
-  const PitchResult(this.frequency, this.confidence);
+  const PitchResult(
+    this.frequency,
+    this.confidence, {
+    this.smoothedFrequency = -1.0,
+    this.driftCentsPerSecond = 0.0,
+  });
 
   bool get hasPitch => frequency > 0;
 
@@ -78,6 +426,269 @@ class PitchResult {
       'PitchResult(freq: ${frequency.toStringAsFixed(2)} Hz, conf: ${(confidence * 100).toStringAsFixed(1)}%)';
 }
 
+// ============================================================================
+// Engine Snapshot (consistent copy of the shared result block)
+// ============================================================================
+
+class TunerSnapshot {
+  final int count; // Increases with every published estimate
+  final PitchResult result;
+  final bool gateOpen;
+  final bool idle;
+  final double humFrequency;
+  final int qualityLevel; // CPU governor level, 0 = full quality
+  final ResultTiming? timing; // Null if the library predates timestamps
+
+  const TunerSnapshot(
+    this.count,
+    this.result, {
+    this.gateOpen = false,
+    this.idle = false,
+    this.humFrequency = 0.0,
+    this.qualityLevel = 0,
+    this.timing,
+  });
+}
+
+/// When an estimate's audio was captured and what happened to it before it
+/// was published, in seconds on the engine clock ([AudioEngine.now])
+class ResultTiming {
+  final double audioTime; // Middle of the analysed window
+  final double blockArrival; // Block with the newest sample reached the engine
+  final double analysisStart;
+  final double analysisEnd;
+
+  const ResultTiming(
+    this.audioTime,
+    this.blockArrival,
+    this.analysisStart,
+    this.analysisEnd,
+  );
+}
+
+// ============================================================================
+// Latency Log (capture-to-display breakdown per estimate)
+// ============================================================================
+
+/// One estimate's path from microphone to screen. [painted] is when the UI
+/// frame showing it was built, on the same clock as [timing].
+class LatencyRecord {
+  final ResultTiming timing;
+  final double painted;
+
+  const LatencyRecord(this.timing, this.painted);
+
+  /// Half the analysis window plus the capture buffer the audio waited in
+  double get capture => timing.blockArrival - timing.audioTime;
+
+  /// Waiting in the capture ring for the analysis thread
+  double get queue => timing.analysisStart - timing.blockArrival;
+
+  double get analysis => timing.analysisEnd - timing.analysisStart;
+
+  /// From publishing to the frame that showed it (vsync wait + build)
+  double get display => painted - timing.analysisEnd;
+
+  double get total => painted - timing.audioTime;
+}
+
+/// Segment averages over the records currently held, in seconds
+class LatencySummary {
+  final int count;
+  final double capture;
+  final double queue;
+  final double analysis;
+  final double display;
+  final double total;
+  final double worstTotal;
+
+  const LatencySummary(
+    this.count,
+    this.capture,
+    this.queue,
+    this.analysis,
+    this.display,
+    this.total,
+    this.worstTotal,
+  );
+}
+
+/// The most recent [capacity] latency records, oldest overwritten first
+class LatencyLog {
+  final int capacity;
+  final List<LatencyRecord> _records = [];
+  int _next = 0; // Slot the next record overwrites once full
+
+  LatencyLog({this.capacity = 600});
+
+  int get length => _records.length;
+
+  void add(LatencyRecord record) {
+    if (_records.length < capacity) {
+      _records.add(record);
+    } else {
+      _records[_next] = record;
+      _next = (_next + 1) % capacity;
+    }
+  }
+
+  void clear() {
+    _records.clear();
+    _next = 0;
+  }
+
+  /// Records oldest first
+  Iterable<LatencyRecord> get records sync* {
+    for (var i = 0; i < _records.length; i++) {
+      yield _records[(_next + i) % _records.length];
+    }
+  }
+
+  LatencySummary summarize() {
+    var capture = 0.0, queue = 0.0, analysis = 0.0, display = 0.0;
+    var total = 0.0, worst = 0.0;
+    for (final r in _records) {
+      capture += r.capture;
+      queue += r.queue;
+      analysis += r.analysis;
+      display += r.display;
+      total += r.total;
+      if (r.total > worst) worst = r.total;
+    }
+    final n = _records.isEmpty ? 1 : _records.length;
+    return LatencySummary(
+      _records.length,
+      capture / n,
+      queue / n,
+      analysis / n,
+      display / n,
+      total / n,
+      worst,
+    );
+  }
+
+  /// Raw timestamps (engine clock, s) and segments (ms), one row per record
+  String toCsv() {
+    final out = StringBuffer(
+      'audio_time,block_arrival,analysis_start,analysis_end,painted,'
+      'capture_ms,queue_ms,analysis_ms,display_ms,total_ms\n',
+    );
+    for (final r in records) {
+      final t = r.timing;
+      out.writeln(
+        [
+          t.audioTime.toStringAsFixed(6),
+          t.blockArrival.toStringAsFixed(6),
+          t.analysisStart.toStringAsFixed(6),
+          t.analysisEnd.toStringAsFixed(6),
+          r.painted.toStringAsFixed(6),
+          (r.capture * 1000).toStringAsFixed(3),
+          (r.queue * 1000).toStringAsFixed(3),
+          (r.analysis * 1000).toStringAsFixed(3),
+          (r.display * 1000).toStringAsFixed(3),
+          (r.total * 1000).toStringAsFixed(3),
+        ].join(','),
+      );
+    }
+    return out.toString();
+  }
+}
+
+// ============================================================================
+// Trail History (displayed cents, evenly timed)
+// ============================================================================
+
+/// Ring of displayed tuning offsets in cents, [kTrailEntriesPerSecond]
+/// entries per second; NaN marks silence. Entry i is at
+/// `cents[i & (capacity - 1)]`; [head] counts the entries written and only
+/// grows (wrapping at 2^32), so readers remember a start mark instead of
+/// clearing it. The engine's ring is read in place without an FFI call.
+class TrailHistory {
+  final Float32List cents;
+  final ffi.Pointer<NativeTunerTrail>? _native;
+  int _localHead = 0;
+
+  TrailHistory._fromEngine(ffi.Pointer<NativeTunerTrail> native)
+    : _native = native,
+      cents = (native.cast<ffi.Uint32>() + 2).cast<ffi.Float>().asTypedList(
+        native.ref.capacity,
+      );
+
+  /// A ring kept on the Dart side and filled with [append], for libraries
+  /// without tuner_trail. [capacity] must be a power of two.
+  TrailHistory.local(int capacity)
+    : _native = null,
+      cents = Float32List(capacity);
+
+  int get capacity => cents.length;
+
+  /// Entries written so far (mod 2^32)
+  int get head => _native?.ref.head ?? _localHead;
+
+  /// Entries written between [start] (an earlier [head]) and [head],
+  /// at most [capacity]
+  int countSince(int start, int head) {
+    final count = (head - start) & 0xFFFFFFFF;
+    return count < capacity ? count : capacity;
+  }
+
+  /// Entry [age] steps back from [head] (0 = newest)
+  double at(int head, int age) => cents[(head - 1 - age) & (capacity - 1)];
+
+  void append(double value) {
+    cents[_localHead & (capacity - 1)] = value;
+    _localHead = (_localHead + 1) & 0xFFFFFFFF;
+  }
+}
+
+// ============================================================================
+// Real-Time Audit Report (calls made while a frame was being processed)
+// ============================================================================
+
+class RtAuditReport {
+  final int frames;
+  final int allocations;
+  final int frees;
+  final int locks;
+
+  const RtAuditReport(this.frames, this.allocations, this.frees, this.locks);
+
+  bool get clean => allocations == 0 && frees == 0 && locks == 0;
+
+  @override
+  String toString() =>
+      'RtAuditReport(frames: $frames, allocations: $allocations, frees: $frees, locks: $locks)';
+}
+
+// ============================================================================
+// Zero-Copy Capture Writers
+// ============================================================================
+
+// A typed list's .address may only be passed straight to a leaf @Native
+// function, not to one bound with asFunction. These resolve in the process,
+// so they are only used where the library is linked into it (iOS, macOS);
+// elsewhere ingestCapture copies through the engine's input buffer.
+@ffi.Native<NativeCaptureWrite>(symbol: 'tuner_capture_write', isLeaf: true)
+external int _nativeCaptureWrite(ffi.Pointer<ffi.Float> samples, int n);
+
+@ffi.Native<NativeCaptureWriteF64>(
+  symbol: 'tuner_capture_write_f64',
+  isLeaf: true,
+)
+external int _nativeCaptureWriteF64(ffi.Pointer<ffi.Double> samples, int n);
+
+// Whether both resolve (symbols are looked up on the first call; an empty
+// write is a no-op)
+bool _nativeCaptureWritersResolve() {
+  try {
+    _nativeCaptureWrite(ffi.nullptr, 0);
+    _nativeCaptureWriteF64(ffi.nullptr, 0);
+    return true;
+  } catch (e) {
+    return false;
+  }
+}
+
 // ============================================================================
 // Audio Engine - YIN Pitch Detection
 // ============================================================================
@@ -86,20 +697,69 @@ class AudioEngine {
   late ffi.DynamicLibrary _lib;
   late DartDetectPitch _detectPitch;
   late DartDetectPitchWithConfidence _detectPitchWithConfidence;
+  DartDetectPitchSmoothed? _detectPitchSmoothed;
   DartCleanup? _cleanup;
   DartSetTuningMode? _setTuningMode;
   DartSetNoiseThreshold? _setNoiseThreshold;
   DartSetFrequencyRange? _setFrequencyRange;
   DartResetFrequencyRange? _resetFrequencyRange;
   DartIsGateOpen? _isGateOpen;
-
-  // Reusable buffer for audio data (avoids allocation every frame)
+  DartIsIdle? _isIdle;
+  DartSetHumRejection? _setHumRejection;
+  DartGetHumFrequency? _getHumFrequency;
+  DartSetSpectralDenoiser? _setSpectralDenoiser;
+  DartInputBufferAlloc? _inputBufferAlloc;
+  DartInputBufferFree? _inputBufferFree;
+  DartPrepare? _prepare;
+  DartIsMemoryLocked? _isMemoryLocked;
+  DartMemoryFootprint? _memoryFootprint;
+  DartSetCpuBudget? _setCpuBudget;
+  DartQualityLevel? _qualityLevel;
+  DartCpuLoad? _cpuLoad;
+  DartRtAudit? _rtAudit;
+  DartRtAuditReset? _rtAuditReset;
+  DartStreamConfigure? _streamConfigure;
+  DartStreamPush? _streamPush;
+  DartStreamPoll? _streamPoll;
+  DartAnalysisStart? _analysisStart;
+  DartAnalysisStop? _analysisStop;
+  DartCaptureWrite? _captureWrite;
+
+  // Capture buffers go to the ring by address through the @Native writers
+  // (only where the library is linked into the process and exports them)
+  bool _zeroCopyCapture = false;
+  DartCaptureOverruns? _captureOverruns;
+  DartSetResultCallback? _setResultCallback;
+  DartSetTrailReference? _setTrailReference;
+  DartNow? _now;
+
+  // Displayed-cents history written by the engine (null if not exported)
+  TrailHistory? _trail;
+
+  // Listener the worker thread posts results through (null if not requested)
+  ffi.NativeCallable<NativeResultCallback>? _resultCallable;
+  bool _workerRunning = false;
+
+  // Shared result block, mapped once; reading it is plain memory access
+  NativeTunerSharedResult? _shared;
+  TunerSnapshot? _sharedSnapshot; // Last one read; reused until count moves
+
+  // Input samples live in native memory; _audioView is a Float32List over
+  // the same bytes, so filling it is the only copy. Each instance has its
+  // own buffer (from tuner_input_buffer_alloc, or calloc with an older
+  // library), so engines in other isolates never write into it. Buffers
+  // outgrown are kept until dispose, since views of them may still be held.
   ffi.Pointer<ffi.Float>? _audioBuffer;
+  Float32List? _audioView;
   int _audioBufferSize = 0;
+  final List<ffi.Pointer<ffi.Float>> _retiredAudioBuffers = [];
 
   // Reusable buffer for confidence output
   ffi.Pointer<ffi.Float>? _confidencePtr;
 
+  // Reusable result struct for smoothed detection
+  ffi.Pointer<NativeTunerResult>? _resultPtr;
+
   // Default sample rate (can be overridden)
   int sampleRate = 44100;
 
@@ -122,6 +782,88 @@ class AudioEngine {
       _lib = ffi.DynamicLibrary.process();
     }
 
+    // One lookup and no per-call transition overhead where the library
+    // exports its function table; older libraries are bound symbol by symbol
+    if (!_bindApi()) {
+      _bindSymbols();
+    }
+
+    // The @Native writers resolve in the process, which only finds this
+    // library where it is linked in rather than opened
+    _zeroCopyCapture =
+        (Platform.isIOS || Platform.isMacOS) &&
+        _captureWrite != null &&
+        _nativeCaptureWritersResolve();
+
+    // Pre-allocate confidence pointer and result struct
+    _confidencePtr = calloc<ffi.Float>(1);
+    _resultPtr = calloc<NativeTunerResult>();
+  }
+
+  // Bind every entry point from the versioned table. Calls that finish in
+  // microseconds and never call back into Dart are leaf calls. Detection,
+  // tuner_push (which may analyze inline) and anything that allocates,
+  // spawns or joins a thread are not: a leaf call holds off garbage
+  // collection for the whole isolate group while it runs.
+  bool _bindApi() {
+    final ffi.Pointer<NativeTunerApi> table;
+    try {
+      final DartGetApi getApi = _lib
+          .lookup<ffi.NativeFunction<NativeGetApi>>('tuner_get_api')
+          .asFunction();
+      table = getApi(kTunerApiVersion);
+    } catch (e) {
+      return false;
+    }
+    if (table == ffi.nullptr) return false;
+    final api = table.ref;
+
+    _detectPitch = api.detectPitch.asFunction();
+    _detectPitchWithConfidence = api.detectPitchWithConfidence.asFunction();
+    _detectPitchSmoothed = api.detectPitchSmoothed.asFunction();
+    _cleanup = api.cleanup.asFunction();
+    _setTuningMode = api.setTuningMode.asFunction(isLeaf: true);
+    _setNoiseThreshold = api.setNoiseThreshold.asFunction(isLeaf: true);
+    _setFrequencyRange = api.setFrequencyRange.asFunction(isLeaf: true);
+    _resetFrequencyRange = api.resetFrequencyRange.asFunction(isLeaf: true);
+    _isGateOpen = api.isGateOpen.asFunction(isLeaf: true);
+    _isIdle = api.isIdle.asFunction(isLeaf: true);
+    _setHumRejection = api.setHumRejection.asFunction(isLeaf: true);
+    _getHumFrequency = api.getHumFrequency.asFunction(isLeaf: true);
+    _setSpectralDenoiser = api.setSpectralDenoiser.asFunction(isLeaf: true);
+    _inputBufferAlloc = api.inputBufferAlloc.asFunction();
+    _inputBufferFree = api.inputBufferFree.asFunction();
+    _prepare = api.prepare.asFunction();
+    _isMemoryLocked = api.isMemoryLocked.asFunction(isLeaf: true);
+    _memoryFootprint = api.memoryFootprint.asFunction(isLeaf: true);
+    _setCpuBudget = api.setCpuBudget.asFunction(isLeaf: true);
+    _qualityLevel = api.qualityLevel.asFunction(isLeaf: true);
+    _cpuLoad = api.cpuLoad.asFunction(isLeaf: true);
+    if (api.capabilities & kTunerCapRtAudit != 0) {
+      _rtAudit = api.rtAudit.asFunction(isLeaf: true);
+      _rtAuditReset = api.rtAuditReset.asFunction(isLeaf: true);
+    }
+    _streamConfigure = api.streamConfigure.asFunction();
+    _streamPush = api.streamPush.asFunction();
+    _streamPoll = api.streamPoll.asFunction(isLeaf: true);
+    _analysisStart = api.analysisStart.asFunction();
+    _analysisStop = api.analysisStop.asFunction();
+    _captureWrite = api.captureWrite.asFunction(isLeaf: true);
+    _captureOverruns = api.captureOverruns.asFunction(isLeaf: true);
+    _setResultCallback = api.setResultCallback.asFunction(isLeaf: true);
+    final DartSharedResult sharedResult = api.sharedResult.asFunction(
+      isLeaf: true,
+    );
+    _shared = sharedResult().ref;
+    final DartTrail trail = api.trail.asFunction(isLeaf: true);
+    _trail = TrailHistory._fromEngine(trail());
+    _setTrailReference = api.setTrailReference.asFunction(isLeaf: true);
+    _now = api.now.asFunction(isLeaf: true);
+    return true;
+  }
+
+  // Look up each entry point by name, tolerating any that are missing
+  void _bindSymbols() {
     // Load the main pitch detection function
     _detectPitch = _lib
         .lookup<ffi.NativeFunction<NativeDetectPitch>>('detect_pitch')
@@ -135,6 +877,16 @@ class AudioEngine {
         .asFunction();
 
     // Try to load optional functions
+    try {
+      _detectPitchSmoothed = _lib
+          .lookup<ffi.NativeFunction<NativeDetectPitchSmoothed>>(
+            'detect_pitch_smoothed',
+          )
+          .asFunction();
+    } catch (e) {
+      _detectPitchSmoothed = null;
+    }
+
     try {
       _cleanup = _lib
           .lookup<ffi.NativeFunction<NativeCleanup>>('cleanup_pitch_detector')
@@ -189,8 +941,196 @@ class AudioEngine {
       _isGateOpen = null;
     }
 
-    // Pre-allocate confidence pointer
-    _confidencePtr = calloc<ffi.Float>(1);
+    try {
+      _isIdle = _lib
+          .lookup<ffi.NativeFunction<NativeIsIdle>>('is_idle')
+          .asFunction();
+    } catch (e) {
+      _isIdle = null;
+    }
+
+    try {
+      _setHumRejection = _lib
+          .lookup<ffi.NativeFunction<NativeSetHumRejection>>(
+            'set_hum_rejection',
+          )
+          .asFunction();
+    } catch (e) {
+      _setHumRejection = null;
+    }
+
+    try {
+      _getHumFrequency = _lib
+          .lookup<ffi.NativeFunction<NativeGetHumFrequency>>(
+            'get_hum_frequency',
+          )
+          .asFunction();
+    } catch (e) {
+      _getHumFrequency = null;
+    }
+
+    try {
+      _setSpectralDenoiser = _lib
+          .lookup<ffi.NativeFunction<NativeSetSpectralDenoiser>>(
+            'set_spectral_denoiser',
+          )
+          .asFunction();
+    } catch (e) {
+      _setSpectralDenoiser = null;
+    }
+
+    try {
+      _inputBufferAlloc = _lib
+          .lookup<ffi.NativeFunction<NativeInputBufferAlloc>>(
+            'tuner_input_buffer_alloc',
+          )
+          .asFunction();
+      _inputBufferFree = _lib
+          .lookup<ffi.NativeFunction<NativeInputBufferFree>>(
+            'tuner_input_buffer_free',
+          )
+          .asFunction();
+    } catch (e) {
+      _inputBufferAlloc = null;
+      _inputBufferFree = null;
+    }
+
+    try {
+      _prepare = _lib
+          .lookup<ffi.NativeFunction<NativePrepare>>('tuner_prepare')
+          .asFunction();
+      _isMemoryLocked = _lib
+          .lookup<ffi.NativeFunction<NativeIsMemoryLocked>>('is_memory_locked')
+          .asFunction();
+      _memoryFootprint = _lib
+          .lookup<ffi.NativeFunction<NativeMemoryFootprint>>(
+            'tuner_memory_footprint',
+          )
+          .asFunction();
+    } catch (e) {
+      _prepare = null;
+      _isMemoryLocked = null;
+      _memoryFootprint = null;
+    }
+
+    try {
+      _setCpuBudget = _lib
+          .lookup<ffi.NativeFunction<NativeSetCpuBudget>>(
+            'tuner_set_cpu_budget',
+          )
+          .asFunction();
+      _qualityLevel = _lib
+          .lookup<ffi.NativeFunction<NativeQualityLevel>>(
+            'tuner_quality_level',
+          )
+          .asFunction();
+      _cpuLoad = _lib
+          .lookup<ffi.NativeFunction<NativeCpuLoad>>('tuner_cpu_load')
+          .asFunction();
+    } catch (e) {
+      _setCpuBudget = null;
+      _qualityLevel = null;
+      _cpuLoad = null;
+    }
+
+    try {
+      _rtAudit = _lib
+          .lookup<ffi.NativeFunction<NativeRtAudit>>('tuner_rt_audit')
+          .asFunction();
+      _rtAuditReset = _lib
+          .lookup<ffi.NativeFunction<NativeRtAuditReset>>(
+            'tuner_rt_audit_reset',
+          )
+          .asFunction();
+    } catch (e) {
+      _rtAudit = null;
+      _rtAuditReset = null;
+    }
+
+    try {
+      _streamConfigure = _lib
+          .lookup<ffi.NativeFunction<NativeStreamConfigure>>(
+            'tuner_stream_configure',
+          )
+          .asFunction();
+      _streamPush = _lib
+          .lookup<ffi.NativeFunction<NativeStreamPush>>('tuner_push')
+          .asFunction();
+      _streamPoll = _lib
+          .lookup<ffi.NativeFunction<NativeStreamPoll>>('tuner_poll')
+          .asFunction();
+    } catch (e) {
+      _streamConfigure = null;
+      _streamPush = null;
+      _streamPoll = null;
+    }
+
+    try {
+      _analysisStart = _lib
+          .lookup<ffi.NativeFunction<NativeAnalysisStart>>(
+            'tuner_analysis_start',
+          )
+          .asFunction();
+      _analysisStop = _lib
+          .lookup<ffi.NativeFunction<NativeAnalysisStop>>('tuner_analysis_stop')
+          .asFunction();
+      _captureWrite = _lib
+          .lookup<ffi.NativeFunction<NativeCaptureWrite>>('tuner_capture_write')
+          .asFunction();
+      _captureOverruns = _lib
+          .lookup<ffi.NativeFunction<NativeCaptureOverruns>>(
+            'tuner_capture_overruns',
+          )
+          .asFunction();
+    } catch (e) {
+      _analysisStart = null;
+      _analysisStop = null;
+      _captureWrite = null;
+      _captureOverruns = null;
+    }
+
+    try {
+      final DartSharedResult sharedResult = _lib
+          .lookup<ffi.NativeFunction<NativeSharedResult>>('tuner_shared_result')
+          .asFunction();
+      _shared = sharedResult().ref;
+    } catch (e) {
+      _shared = null;
+    }
+
+    try {
+      _setResultCallback = _lib
+          .lookup<ffi.NativeFunction<NativeSetResultCallback>>(
+            'tuner_set_result_callback',
+          )
+          .asFunction();
+    } catch (e) {
+      _setResultCallback = null;
+    }
+
+    try {
+      final DartTrail trail = _lib
+          .lookup<ffi.NativeFunction<NativeTrail>>('tuner_trail')
+          .asFunction();
+      _setTrailReference = _lib
+          .lookup<ffi.NativeFunction<NativeSetTrailReference>>(
+            'tuner_set_trail_reference',
+          )
+          .asFunction();
+      _trail = TrailHistory._fromEngine(trail());
+    } catch (e) {
+      _trail = null;
+      _setTrailReference = null;
+    }
+
+    // Also marks the shared block as carrying result timestamps
+    try {
+      _now = _lib
+          .lookup<ffi.NativeFunction<NativeNow>>('tuner_now')
+          .asFunction(isLeaf: true);
+    } catch (e) {
+      _now = null;
+    }
   }
 
   /// Set the tuning mode (chromatic, guitar, or piano)
@@ -220,6 +1160,25 @@ class AudioEngine {
   /// Check if the noise gate is currently open (signal detected)
   bool get isGateOpen => _isGateOpen?.call() ?? false;
 
+  /// Check if the engine is in low-power idle mode (long silence).
+  /// While idle, only a strided subset of every other frame is examined.
+  bool get isIdle => _isIdle?.call() ?? false;
+
+  /// Enable or disable automatic 50/60 Hz mains hum rejection (on by default)
+  void setHumRejection(bool enabled) {
+    _setHumRejection?.call(enabled);
+  }
+
+  /// Mains frequency currently being notched out, or 0 if no hum is detected
+  double get humFrequency => _getHumFrequency?.call() ?? 0.0;
+
+  /// Enable or disable the spectral subtraction denoiser (off by default).
+  /// The noise spectrum is learned while the gate is closed, so leave a few
+  /// seconds of silence after enabling it before playing.
+  void setSpectralDenoiser(bool enabled) {
+    _setSpectralDenoiser?.call(enabled);
+  }
+
   /// Process audio data and return detected pitch frequency.
   /// Returns -1.0 if no pitch is detected.
   double processAudio(List<double> audioData) {
@@ -264,16 +1223,370 @@ class AudioEngine {
     return PitchResult(frequency, confidence);
   }
 
+  /// Process audio data with native smoothing.
+  /// Returns raw and smoothed pitch plus the drift rate in cents/second,
+  /// so the UI can show which way the pitch is moving without its own filter.
+  PitchResult processAudioSmoothed(List<double> audioData) {
+    if (audioData.isEmpty) return const PitchResult(-1.0, 0.0);
+
+    final detect = _detectPitchSmoothed;
+    if (detect == null) {
+      // Older native library: fall back to unsmoothed detection
+      final result = processAudioWithConfidence(audioData);
+      return PitchResult(
+        result.frequency,
+        result.confidence,
+        smoothedFrequency: result.frequency,
+      );
+    }
+
+    _ensureBufferSize(audioData.length);
+    _copyToNativeBuffer(audioData);
+    return processInputSmoothed(audioData.length);
+  }
+
+  /// View of the native input buffer, [length] samples long. Write capture
+  /// data straight into it, then call processInputSmoothed or
+  /// writeCaptureInput with the same length: native code reads the samples
+  /// in place. A later call with a larger length may move the buffer: a
+  /// view kept across calls stays valid memory until [dispose], but is no
+  /// longer what gets analyzed.
+  Float32List inputBuffer(int length) {
+    if (length <= 0) return Float32List(0);
+    _ensureBufferSize(length);
+    return Float32List.sublistView(_audioView!, 0, length);
+  }
+
+  /// Smoothed detection on the first [length] samples of [inputBuffer]
+  PitchResult processInputSmoothed(int length) {
+    final detect = _detectPitchSmoothed;
+    final buffer = _audioBuffer;
+    if (buffer == null || length <= 0 || length > _audioBufferSize) {
+      return const PitchResult(-1.0, 0.0);
+    }
+    if (detect == null) {
+      // Older native library: fall back to unsmoothed detection
+      _confidencePtr![0] = 0.0;
+      final frequency = _detectPitchWithConfidence(
+        buffer,
+        length,
+        sampleRate,
+        _confidencePtr!,
+      );
+      return PitchResult(
+        frequency,
+        _confidencePtr![0],
+        smoothedFrequency: frequency,
+      );
+    }
+
+    detect(buffer, length, sampleRate, _resultPtr!);
+
+    final result = _resultPtr!.ref;
+    return PitchResult(
+      result.pitchHz,
+      result.confidence,
+      smoothedFrequency: result.smoothedPitchHz,
+      driftCentsPerSecond: result.driftCentsPerSecond,
+    );
+  }
+
+  /// Allocate all native scratch memory up front for real-time use.
+  /// After this, detection never allocates; frames longer than [maxLength]
+  /// samples or at a different sampleRate are rejected as "no pitch".
+  /// [lockMemory] also asks the OS to keep it resident (best effort).
+  bool prepare({int maxLength = 8192, bool lockMemory = false}) {
+    return _prepare?.call(maxLength, sampleRate, lockMemory) ?? false;
+  }
+
+  /// Whether prepare managed to lock the scratch memory in RAM
+  bool get isMemoryLocked => _isMemoryLocked?.call() ?? false;
+
+  /// Exact size in bytes of the native scratch arena (0 before first use)
+  int get memoryFootprint => _memoryFootprint?.call() ?? 0;
+
+  /// Limit analysis to [budget] of real time (0.5 = half the duration of
+  /// the audio analyzed). When over budget the engine lowers its quality
+  /// level: half-rate YIN first, then fewer estimates per second. It steps
+  /// back up once there is headroom again. 0 disables the governor.
+  void setCpuBudget(double budget) {
+    _setCpuBudget?.call(budget);
+  }
+
+  /// Displayed-cents history the engine writes as audio is analyzed, or
+  /// null if the native library predates it
+  TrailHistory? get trail => _trail;
+
+  /// Make the trail show cents from [referenceHz] (clamped to +-100), or
+  /// from the nearest note when it is 0. Applies from the next estimate.
+  void setTrailReference(double referenceHz) {
+    _setTrailReference?.call(referenceHz);
+  }
+
+  /// Engine monotonic clock in seconds, the one [ResultTiming] uses, or
+  /// null if the native library predates result timestamps
+  double? get now => _now?.call();
+
+  /// Current governor quality level (0 = full quality, higher = cheaper)
+  int get qualityLevel => _qualityLevel?.call() ?? 0;
+
+  /// Smoothed analysis cost as a fraction of real time
+  double get cpuLoad => _cpuLoad?.call() ?? 0.0;
+
+  /// Allocations, frees and mutex locks the engine made while processing
+  /// frames since the last [resetRtAudit]. Null unless the native library
+  /// was built with -DNOTEFY_RT_AUDIT=ON.
+  RtAuditReport? rtAudit() {
+    final audit = _rtAudit;
+    if (audit == null) return null;
+
+    final report = calloc<NativeTunerRtAudit>();
+    try {
+      if (!audit(report)) return null;
+      final r = report.ref;
+      return RtAuditReport(r.frames, r.allocations, r.frees, r.locks);
+    } finally {
+      calloc.free(report);
+    }
+  }
+
+  /// Zero the audit counters. With [trap], the next violation aborts the
+  /// process instead of being counted, so a debugger stops right on it.
+  void resetRtAudit({bool trap = false}) {
+    _rtAuditReset?.call(trap);
+  }
+
+  /// Configure the streaming API. An estimate is produced every [hopSize]
+  /// samples over the most recent [windowSize] samples, independent of the
+  /// capture buffer size. Returns false if the native library lacks the
+  /// streaming API or the sizes are rejected; use processAudioSmoothed then.
+  /// Do not mix streaming and per-frame calls on the same engine.
+  bool configureStream({int windowSize = 8192, int hopSize = 2048}) {
+    return _streamConfigure?.call(windowSize, hopSize, sampleRate) ?? false;
+  }
+
+  /// Push captured samples of any length into the stream.
+  /// Returns the number of new estimates produced.
+  int pushAudio(List<double> audioData) {
+    final push = _streamPush;
+    if (push == null || audioData.isEmpty) return 0;
+
+    _ensureBufferSize(audioData.length);
+    _copyToNativeBuffer(audioData);
+
+    return push(_audioBuffer!, audioData.length);
+  }
+
+  /// Latest streaming estimate, or null if none arrived since the last poll.
+  PitchResult? pollResult() {
+    final poll = _streamPoll;
+    if (poll == null || !poll(_resultPtr!)) return null;
+
+    final result = _resultPtr!.ref;
+    return PitchResult(
+      result.pitchHz,
+      result.confidence,
+      smoothedFrequency: result.smoothedPitchHz,
+      driftCentsPerSecond: result.driftCentsPerSecond,
+    );
+  }
+
+  /// Start the native analysis thread. Call configureStream first.
+  /// Captured audio then goes through writeCapture, which only copies into
+  /// a lock-free ring; YIN runs on the native thread and results are read
+  /// with pollResult. [ringCapacity] is in samples (0 = ~0.74s default).
+  bool startAnalysisThread({int ringCapacity = 0}) {
+    return _analysisStart?.call(ringCapacity) ?? false;
+  }
+
+  /// Stop and join the native analysis thread
+  void stopAnalysisThread() {
+    _analysisStop?.call();
+  }
+
+  /// Hand captured samples to the analysis thread. Never blocks; returns
+  /// the number of samples accepted (the rest are counted as overruns).
+  int writeCapture(List<double> audioData) {
+    final write = _captureWrite;
+    if (write == null || audioData.isEmpty) return 0;
+
+    _ensureBufferSize(audioData.length);
+    _copyToNativeBuffer(audioData);
+
+    return write(_audioBuffer!, audioData.length);
+  }
+
+  /// Hand the first [length] samples of [inputBuffer] to the analysis thread
+  int writeCaptureInput(int length) {
+    final write = _captureWrite;
+    final buffer = _audioBuffer;
+    if (write == null || buffer == null || length <= 0) return 0;
+    if (length > _audioBufferSize) return 0;
+
+    return write(buffer, length);
+  }
+
+  /// Hand a capture callback's buffer to the analysis thread.
+  /// Where the library is linked into the process, a Float32List or
+  /// Float64List is passed by address in a single leaf call (doubles are
+  /// narrowed natively), so nothing is copied on the Dart side. Otherwise,
+  /// and for any other list of numbers, the samples are bulk-copied into
+  /// [inputBuffer] first. Returns the number of samples accepted.
+  int ingestCapture(Object data) {
+    if (_zeroCopyCapture) {
+      if (data is Float32List) {
+        return _nativeCaptureWrite(data.address, data.length);
+      } else if (data is Float64List) {
+        return _nativeCaptureWriteF64(data.address, data.length);
+      }
+    }
+    final length = _copyCapture(data);
+    return writeCaptureInput(length);
+  }
+
+  /// Smoothed whole-frame detection on a capture callback's buffer, for
+  /// when the worker is unavailable. The samples are bulk-copied into
+  /// [inputBuffer] and analyzed there.
+  PitchResult processCaptureSmoothed(Object data) {
+    final length = _copyCapture(data);
+    if (length == 0) return const PitchResult(-1.0, 0.0);
+    return processInputSmoothed(length);
+  }
+
+  // Copy capture data of any list type into the input buffer
+  int _copyCapture(Object data) {
+    if (data is! List || data.isEmpty) return 0;
+    _ensureBufferSize(data.length);
+    final view = _audioView!;
+    if (data is List<double>) {
+      view.setRange(0, data.length, data);
+    } else {
+      for (var i = 0; i < data.length; i++) {
+        view[i] = (data[i] as num).toDouble();
+      }
+    }
+    return data.length;
+  }
+
+  /// Samples dropped since the analysis thread started because it fell behind
+  int get captureOverruns => _captureOverruns?.call() ?? 0;
+
+  /// Run detection on an engine-owned native worker thread.
+  /// Feed audio with writeCapture. Results are read at frame time with
+  /// readSharedResult, and if [onResult] is given every estimate is also
+  /// posted to it on this isolate. No DSP runs on the caller's thread.
+  /// Returns false if the native library lacks the worker API.
+  bool startWorker({
+    void Function(PitchResult)? onResult,
+    int windowSize = 8192,
+    int hopSize = 2048,
+  }) {
+    final setCallback = _setResultCallback;
+    if (setCallback == null || _workerRunning) return false;
+    if (!configureStream(windowSize: windowSize, hopSize: hopSize)) {
+      return false;
+    }
+    if (onResult == null) {
+      _workerRunning = startAnalysisThread();
+      return _workerRunning;
+    }
+
+    final callable = ffi.NativeCallable<NativeResultCallback>.listener((
+      double pitchHz,
+      double confidence,
+      double smoothedPitchHz,
+      double driftCentsPerSecond,
+    ) {
+      onResult(
+        PitchResult(
+          pitchHz,
+          confidence,
+          smoothedFrequency: smoothedPitchHz,
+          driftCentsPerSecond: driftCentsPerSecond,
+        ),
+      );
+    });
+
+    setCallback(callable.nativeFunction);
+    if (!startAnalysisThread()) {
+      setCallback(ffi.nullptr);
+      callable.close();
+      return false;
+    }
+    _resultCallable = callable;
+    _workerRunning = true;
+    return true;
+  }
+
+  /// Stop the worker thread. The callback is released only after the
+  /// thread has been joined, so no result can arrive through a closed port.
+  void stopWorker() {
+    if (!_workerRunning) return;
+
+    stopAnalysisThread();
+    _workerRunning = false;
+
+    final callable = _resultCallable;
+    if (callable != null) {
+      _setResultCallback?.call(ffi.nullptr);
+      callable.close();
+      _resultCallable = null;
+    }
+  }
+
+  /// Whether the native worker thread is running
+  bool get isWorkerRunning => _workerRunning;
+
+  /// Latest published estimate, read from the shared block without an FFI
+  /// call or lock. Meant to be called once per frame; compare [count] with
+  /// the previous snapshot to see whether anything new arrived. Until the
+  /// engine publishes again the same snapshot object is returned, so a
+  /// frame with nothing new costs one load and no allocation.
+  /// Returns null if the block is unavailable or kept changing mid-read.
+  TunerSnapshot? readSharedResult() {
+    final shared = _shared;
+    if (shared == null) return null;
+
+    // The count only grows and moves before anything else in a write
+    final cached = _sharedSnapshot;
+    if (cached != null && shared.count == cached.count) return cached;
+
+    for (var attempt = 0; attempt < 4; attempt++) {
+      final sequence = shared.sequence;
+      if (sequence.isOdd) continue; // Writer is mid-update
+
+      final snapshot = TunerSnapshot(
+        shared.count,
+        PitchResult(
+          shared.pitchHz,
+          shared.confidence,
+          smoothedFrequency: shared.smoothedPitchHz,
+          driftCentsPerSecond: shared.driftCentsPerSecond,
+        ),
+        gateOpen: shared.gateOpen != 0,
+        idle: shared.idle != 0,
+        humFrequency: shared.humFrequency,
+        qualityLevel: shared.qualityLevel,
+        timing: _now == null
+            ? null
+            : ResultTiming(
+                shared.timing.audioTime,
+                shared.timing.blockArrival,
+                shared.timing.analysisStart,
+                shared.timing.analysisEnd,
+              ),
+      );
+      if (shared.sequence == sequence) return _sharedSnapshot = snapshot;
+    }
+    return null;
+  }
+
   /// Optimized version that takes Float32List directly (avoids conversion)
   double processAudioFloat32(Float32List audioData) {
     if (audioData.isEmpty) return -1.0;
 
     _ensureBufferSize(audioData.length);
-
-    // Direct copy from Float32List is faster
-    for (var i = 0; i < audioData.length; i++) {
-      _audioBuffer![i] = audioData[i];
-    }
+    _copyToNativeBuffer(audioData);
 
     return _detectPitch(_audioBuffer!, audioData.length, sampleRate);
   }
@@ -283,10 +1596,7 @@ class AudioEngine {
     if (audioData.isEmpty) return const PitchResult(-1.0, 0.0);
 
     _ensureBufferSize(audioData.length);
-
-    for (var i = 0; i < audioData.length; i++) {
-      _audioBuffer![i] = audioData[i];
-    }
+    _copyToNativeBuffer(audioData);
 
     _confidencePtr![0] = 0.0;
 
@@ -301,36 +1611,233 @@ class AudioEngine {
   }
 
   void _ensureBufferSize(int requiredSize) {
-    if (_audioBuffer == null || _audioBufferSize < requiredSize) {
-      // Free old buffer if exists
-      if (_audioBuffer != null) {
-        calloc.free(_audioBuffer!);
-      }
-      // Allocate new buffer with some extra space to avoid frequent reallocations
-      _audioBufferSize = (requiredSize * 1.5).toInt();
-      _audioBuffer = calloc<ffi.Float>(_audioBufferSize);
+    if (_audioBuffer != null && _audioBufferSize >= requiredSize) return;
+
+    // Grow with some extra space to avoid frequent reallocations
+    final size = (requiredSize * 1.5).toInt();
+    final alloc = _inputBufferAlloc;
+    final buffer = alloc != null ? alloc(size) : calloc<ffi.Float>(size);
+    if (buffer == ffi.nullptr) {
+      throw StateError('Cannot allocate a $size-sample input buffer');
+    }
+    if (_audioBuffer != null) {
+      _retiredAudioBuffers.add(_audioBuffer!);
     }
+    _audioBuffer = buffer;
+    _audioBufferSize = size;
+    _audioView = buffer.asTypedList(size);
   }
 
-  void _copyToNativeBuffer(List<double> audioData) {
-    for (var i = 0; i < audioData.length; i++) {
-      _audioBuffer![i] = audioData[i];
+  void _freeAudioBuffer(ffi.Pointer<ffi.Float> buffer) {
+    final free = _inputBufferFree;
+    if (free != null) {
+      free(buffer);
+    } else {
+      calloc.free(buffer);
     }
   }
 
+  // One bulk copy into native memory (memmove for a Float32List source)
+  void _copyToNativeBuffer(List<double> audioData) {
+    _audioView!.setRange(0, audioData.length, audioData);
+  }
+
   /// Release native resources
   void dispose() {
+    stopWorker();
+
     // Call native cleanup if available
     _cleanup?.call();
 
     // Free allocated memory
+    _releaseBuffers();
+  }
+
+  // Free this instance's Dart-side allocations without touching the
+  // native engine, which other isolates may still be using
+  void _releaseBuffers() {
     if (_audioBuffer != null) {
-      calloc.free(_audioBuffer!);
-      _audioBuffer = null;
+      _freeAudioBuffer(_audioBuffer!);
     }
+    _retiredAudioBuffers.forEach(_freeAudioBuffer);
+    _retiredAudioBuffers.clear();
+    _audioBuffer = null;
+    _audioView = null;
+    _audioBufferSize = 0;
     if (_confidencePtr != null) {
       calloc.free(_confidencePtr!);
       _confidencePtr = null;
     }
+    if (_resultPtr != null) {
+      calloc.free(_resultPtr!);
+      _resultPtr = null;
+    }
+  }
+}
+
+// ============================================================================
+// Isolate-Hosted Engine (detection on a long-lived background isolate)
+// ============================================================================
+
+/// Runs detection on its own isolate, so neither the DSP nor the FFI calls
+/// around it touch the UI isolate. The worker isolate binds its own
+/// [AudioEngine] (with its own input buffer); capture buffers are moved to
+/// it as [TransferableTypedData] and each estimate comes back as five
+/// floats.
+///
+/// The native engine is one per process: settings made through the UI
+/// isolate's [AudioEngine] apply here too (at the next frame boundary), but
+/// audio must only be fed through this object while it runs. The worker
+/// never prepares or configures that shared engine, so call
+/// [AudioEngine.prepare] on the UI isolate before spawning.
+class IsolateAudioEngine {
+  final ReceivePort _replies;
+  final SendPort _commands;
+  final StreamController<(PitchResult, int)> _results;
+  final Completer<void> _stopped;
+
+  IsolateAudioEngine._(
+    this._replies,
+    this._commands,
+    this._results,
+    this._stopped,
+  );
+
+  /// Start the worker isolate and wait until it is ready for audio
+  static Future<IsolateAudioEngine> spawn({int sampleRate = 44100}) async {
+    final replies = ReceivePort();
+    final events = ReceivePort(); // Uncaught errors, then exit
+    final results = StreamController<(PitchResult, int)>.broadcast();
+    final ready = Completer<SendPort>();
+    final stopped = Completer<void>();
+    replies.listen((message) {
+      if (message is SendPort) {
+        ready.complete(message);
+      } else if (message is Float32List) {
+        if (!results.isClosed) results.add(_decodeResult(message));
+      } else if (message == null) {
+        if (!stopped.isCompleted) stopped.complete();
+      }
+    });
+
+    // Errors are fatal to the worker, which may then exit without ever
+    // replying: fail whoever is waiting on it instead of leaving them hung
+    events.listen((message) {
+      if (message is List) {
+        final error = RemoteError('${message[0]}', '${message[1]}');
+        if (!ready.isCompleted) ready.completeError(error);
+        if (!results.isClosed) results.addError(error);
+        return;
+      }
+      if (!ready.isCompleted) {
+        ready.completeError(StateError('AudioEngine isolate exited'));
+      }
+      if (!stopped.isCompleted) stopped.complete();
+      results.close();
+      replies.close();
+      events.close();
+    });
+
+    try {
+      await Isolate.spawn(
+        _workerMain,
+        (replies.sendPort, sampleRate),
+        onError: events.sendPort,
+        onExit: events.sendPort,
+        debugName: 'AudioEngine',
+      );
+    } catch (e) {
+      replies.close();
+      events.close();
+      await results.close();
+      rethrow;
+    }
+    return IsolateAudioEngine._(
+      replies,
+      await ready.future,
+      results,
+      stopped,
+    );
+  }
+
+  /// Every estimate with the governor quality level it was produced at,
+  /// delivered in capture order on the isolate that called [spawn]
+  Stream<(PitchResult, int)> get results => _results.stream;
+
+  /// Hand one capture buffer to the worker. A Float32List or Float64List
+  /// is copied once into transferable memory and moved, not copied again,
+  /// across the isolate boundary; other lists are narrowed to floats first.
+  void process(Object data) {
+    if (data is! List || data.isEmpty) return;
+    final TypedData samples;
+    if (data is Float32List || data is Float64List) {
+      samples = data as TypedData;
+    } else {
+      samples = Float32List.fromList([
+        for (final sample in data) (sample as num).toDouble(),
+      ]);
+    }
+    _commands.send((
+      TransferableTypedData.fromList([samples]),
+      samples is Float64List,
+    ));
+  }
+
+  /// Stop the worker isolate once it has handled the buffers already sent.
+  /// Results from those are dropped. The future completes when the worker
+  /// has finished its last frame (or has died), after which the native
+  /// engine may be cleaned up. [results] reports an error and closes if
+  /// the worker dies before that.
+  Future<void> dispose() async {
+    if (!_results.isClosed) {
+      await _results.close();
+      _commands.send(null);
+    }
+    await _stopped.future;
+    _replies.close();
+  }
+
+  static (PitchResult, int) _decodeResult(Float32List r) => (
+    PitchResult(
+      r[0],
+      r[1],
+      smoothedFrequency: r[2],
+      driftCentsPerSecond: r[3],
+    ),
+    r[4].toInt(),
+  );
+
+  static void _workerMain((SendPort, int) args) {
+    final (replies, sampleRate) = args;
+    // Binds symbols only: preparing here would rebuild the arena and drop
+    // the stream configuration under the UI isolate's engine
+    final engine = AudioEngine()..sampleRate = sampleRate;
+
+    // One reply buffer, refilled per estimate; send copies its 20 bytes
+    final reply = Float32List(5);
+    final commands = ReceivePort();
+    commands.listen((message) {
+      if (message is (TransferableTypedData, bool)) {
+        final (transferable, isDouble) = message;
+        final buffer = transferable.materialize();
+        final samples = isDouble
+            ? buffer.asFloat64List()
+            : buffer.asFloat32List();
+        final result = engine.processCaptureSmoothed(samples);
+        reply[0] = result.frequency;
+        reply[1] = result.confidence;
+        reply[2] = result.smoothedFrequency;
+        reply[3] = result.driftCentsPerSecond;
+        reply[4] = engine.qualityLevel.toDouble();
+        replies.send(reply);
+      } else if (message == null) {
+        // The native engine outlives this isolate; only release our side.
+        // With its only port closed the isolate exits.
+        engine._releaseBuffers();
+        commands.close();
+        replies.send(null);
+      }
+    });
+    replies.send(commands.sendPort);
   }
 }
@@ -1,5 +1,7 @@
 import 'dart:async';
 import 'dart:math';
+import 'dart:typed_data';
+import 'dart:ui' as ui;
 
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
@@ -155,19 +157,37 @@ class _TunerScreenState extends State<TunerScreen>
     with WidgetsBindingObserver, TickerProviderStateMixin {
   final _audioRecorder = FlutterAudioCapture();
   final _engine = AudioEngine();
+  bool _workerRunning = false; // Native worker thread runs the detection
+  IsolateAudioEngine? _isolateEngine; // Background isolate when it can't
+  Future<void> _isolateStopped = Future.value(); // Last one's final frame done
+  StreamSubscription<(PitchResult, int)>? _isolateResults;
+  int _lastResultCount = 0; // Shared-block count already shown
   final GlobalKey<ScaffoldState> _scaffoldKey = GlobalKey<ScaffoldState>();
 
-  double _currentPitch = 0.0;
-  String _note = "--";
-  int _octave = 0;
-  double _cents = 0.0;
+  // Latest reading; replaced once per estimate. Only the readouts listen.
+  final ValueNotifier<TunerReadout> _readout = ValueNotifier(
+    const TunerReadout(),
+  );
+  // Whether the target peg/key should light up green (changes rarely)
+  final ValueNotifier<bool> _inTune = ValueNotifier(false);
+  double get _currentPitch => _readout.value.pitch;
+  String get _note => _readout.value.note;
+  int get _octave => _readout.value.octave;
+  double get _cents => _readout.value.cents;
   String _status = "Initializing...";
+  int _qualityLevel = 0; // Native CPU governor level, 0 = full quality
   bool _isRecording = false;
   bool _isInitialized = false;
 
-  // Continuous trail data - stores x positions (cents) that scroll upward
-  final List<double> _trailPositions = [];
-  static const int _maxTrailPoints = 150;
+  // Continuous trail data - x positions (cents) that scroll upward. The
+  // engine writes kTrailEntriesPerSecond per second of audio; older
+  // libraries get a ring filled here once per frame. Clearing just moves
+  // the start mark up to the head.
+  late final TrailHistory _trail = _engine.trail ?? TrailHistory.local(256);
+  late final bool _trailFromEngine = _engine.trail != null;
+  int _trailStart = 0;
+  static const int _maxTrailPoints = 150; // 2.5 s of trail
+  bool _lastResultPitched = false; // What the Dart-side trail records
 
   // Timer to continuously add trail points
   Timer? _trailTimer;
@@ -182,87 +202,91 @@ class _TunerScreenState extends State<TunerScreen>
 
   bool _wasRecordingBeforePause = false;
 
-  // Standby mode - smooth return to center when no note detected
-  bool _isInStandby = false;
-  Timer? _standbyTimer;
-  late AnimationController _standbyAnimationController;
-  late Animation<double> _standbyAnimation;
-  double _lastCentsBeforeStandby = 0.0;
-  static const Duration _standbyDelay = Duration(milliseconds: 800);
-  static const Duration _standbyAnimationDuration = Duration(milliseconds: 600);
+  // Standby mode - smooth return to center when no note detected, driven
+  // by the silence at the head of the trail (see StandbyCurve)
+  bool get _isInStandby => _readout.value.isInStandby;
 
   // Continuous scrolling animation for seismograph effect
   late AnimationController _scrollAnimationController;
-  double _scrollOffset =
-      0.0; // Continuous scroll offset (never resets, just wraps)
+  // Per-frame seismograph state; ticking it repaints only the seismograph
+  final SeismographFrame _frame = SeismographFrame();
+  final SeismographBackground _seismographBackground = SeismographBackground();
+  final TrailMesh _trailMesh = TrailMesh();
   static const double _scrollSpeed = 0.8; // Pixels per frame to scroll up
+  static const double _scrollCoastDecay = 0.92; // Per-frame slowdown when stopped
+  double _scrollVelocity = 0.0; // Current pixels per frame
+
+  // Displayed position - already smoothed natively (median + Kalman)
+  double get _displayedCents => _frame.displayedCents;
+  set _displayedCents(double cents) => _frame.displayedCents = cents;
+
+  // Rate of pitch change from the native smoother (cents/second)
+  double get _driftCentsPerSec => _readout.value.driftCentsPerSec;
 
-  // Smooth position tracking - continuously lerps toward target
-  double _displayedCents =
-      0.0; // The actual displayed position (smoothly animated)
-  double _targetCents = 0.0; // Where we want to go
-  static const double _lerpSpeed =
-      0.15; // How fast to lerp (0-1, higher = faster)
+  // Capture-to-display latency, recorded only while the overlay is shown.
+  // Needs the native worker; other capture paths carry no timestamps.
+  bool _showLatency = false;
+  final LatencyLog _latencyLog = LatencyLog();
+  final ValueNotifier<LatencySummary?> _latencySummary = ValueNotifier(null);
 
   @override
   void initState() {
     super.initState();
     WidgetsBinding.instance.addObserver(this);
 
-    // Initialize standby animation controller
-    _standbyAnimationController = AnimationController(
-      vsync: this,
-      duration: _standbyAnimationDuration,
-    );
-    _standbyAnimation = CurvedAnimation(
-      parent: _standbyAnimationController,
-      curve: Curves.easeOutCubic,
-    );
-    _standbyAnimationController.addListener(() {
-      if (mounted) setState(() {});
-    });
-
     // Initialize continuous scroll animation (creates the moving seismograph effect)
-    // This drives smooth updates at 60fps for fluid animation
+    // This drives smooth updates at 60fps for fluid animation while capturing;
+    // it is started by _startCapture and suspends itself once idle
     _scrollAnimationController = AnimationController(
       vsync: this,
       duration: const Duration(milliseconds: 16), // ~60fps tick
-    )..repeat();
+    );
     _scrollAnimationController.addListener(() {
       if (mounted) {
+        // Pick up the worker's latest estimate once per frame
+        if (_workerRunning) _readLatestResult();
+
         // Increment scroll offset continuously
-        _scrollOffset += _scrollSpeed;
-        _updateDisplayedCents();
+        _frame.scrollOffset += _scrollVelocity;
+        if (!_isRecording) {
+          // Coast to a stop, then suspend the ticker until the next start
+          _scrollVelocity *= _scrollCoastDecay;
+          if (_scrollVelocity < 0.01) {
+            _scrollVelocity = 0.0;
+            _scrollAnimationController.stop();
+          }
+        }
         _addTrailPoint();
-        setState(() {});
+        _updateStandby();
+        // Repaint the seismograph only; nothing is rebuilt
+        _frame.tick();
       }
     });
 
     _initAudio();
   }
 
-  // Smoothly interpolate displayed cents toward target
-  void _updateDisplayedCents() {
-    if (_isInStandby) {
-      // During standby, lerp toward 0 (center)
-      _displayedCents = _displayedCents * (1 - _lerpSpeed);
-      // Snap to exactly 0 when very close
-      if (_displayedCents.abs() < 0.1) _displayedCents = 0.0;
-    } else {
-      // Lerp toward target cents
-      _displayedCents =
-          _displayedCents + (_targetCents - _displayedCents) * _lerpSpeed;
+  // Add current position to trail (the engine records its own). Silence
+  // is recorded as NaN, as the engine does.
+  void _addTrailPoint() {
+    if (_isRecording && !_trailFromEngine) {
+      _trail.append(_lastResultPitched ? _displayedCents : double.nan);
     }
   }
 
-  // Add current position to trail
-  void _addTrailPoint() {
-    if (_isRecording) {
-      _trailPositions.insert(0, _displayedCents);
-      while (_trailPositions.length > _maxTrailPoints) {
-        _trailPositions.removeLast();
-      }
+  void _clearTrail() {
+    _trailStart = _trail.head;
+  }
+
+  // Have the engine's trail show cents from the selected target, if any
+  void _updateTrailReference() {
+    double reference = 0.0;
+    if (_tuningMode == TuningMode.guitar && _selectedGuitarString != null) {
+      reference = _selectedGuitarString!.frequency;
+    } else if (_tuningMode == TuningMode.piano && _selectedPianoKey != null) {
+      reference = _selectedPianoKey!.frequency;
     }
+    _engine.setTrailReference(reference);
   }
 
   @override
@@ -288,6 +312,9 @@ class _TunerScreenState extends State<TunerScreen>
     if (status.isGranted) {
       try {
         await _audioRecorder.init();
+        // Size every native buffer for the 8192-sample window now, so the
+        // first frames don't pay for allocation and page faults
+        _engine.prepare(maxLength: 8192, lockMemory: true);
         _isInitialized = true;
         setState(() {
           _status = "Tap to Start";
@@ -308,14 +335,19 @@ class _TunerScreenState extends State<TunerScreen>
   void dispose() {
     WidgetsBinding.instance.removeObserver(this);
     _pianoScrollController.dispose();
-    _standbyTimer?.cancel();
     _trailTimer?.cancel();
-    _standbyAnimationController.dispose();
     _scrollAnimationController.dispose();
+    _frame.dispose();
+    _seismographBackground.dispose();
+    _readout.dispose();
+    _inTune.dispose();
+    _latencySummary.dispose();
     if (_isRecording) {
       _audioRecorder.stop();
     }
-    _engine.dispose(); // Clean up native resources
+    // Clean up native resources, after the background isolate (if any) has
+    // finished its last frame
+    _stopIsolateEngine().whenComplete(_engine.dispose);
     super.dispose();
   }
 
@@ -327,42 +359,158 @@ class _TunerScreenState extends State<TunerScreen>
       return;
     }
 
+    // A background isolate from the previous run may still be finishing a
+    // frame; the native engine must not be fed from two places at once
+    await _isolateStopped;
+
     // Clear trail when starting
-    _trailPositions.clear();
+    _clearTrail();
     _resetStandby();
 
+    // Detection runs on a native worker thread that publishes each estimate
+    // to a shared block read at vsync; this isolate only copies samples across.
+    // The worker keeps the 8192-sample analysis window but updates every
+    // 2048 samples (~46ms), four times as often as whole-buffer analysis.
+    // Smaller hops multiply the quadratic YIN cost and fall behind real time.
+    _workerRunning = _engine.startWorker(windowSize: 8192, hopSize: 2048);
+    _lastResultCount = _engine.readSharedResult()?.count ?? 0;
+    if (!_workerRunning) await _startIsolateEngine();
+
     try {
       await _audioRecorder.start(
         (data) {
-          List<double> buffer = data.map((e) => e.toDouble()).toList();
-          double pitch = _engine.processAudio(buffer);
-
-          if (pitch > 20 && pitch < 5000) {
-            _onPitchDetected(pitch);
+          // The plugin's typed buffer goes to native code in one leaf
+          // call: by address where the library is linked in, otherwise
+          // through one bulk copy into the engine's input buffer.
+          if (_workerRunning) {
+            _engine.ingestCapture(data);
+          } else if (_isolateEngine != null) {
+            _isolateEngine!.process(data);
           } else {
-            _onNoPitchDetected();
+            // No worker of either kind: analyse on this isolate
+            _onPitchResult(_engine.processCaptureSmoothed(data));
+            _onQualityLevel(_engine.qualityLevel);
           }
         },
         onError,
         sampleRate: 44100,
-        // Buffer size of 8192 samples gives ~186ms of audio at 44100Hz
-        // This is optimal for YIN algorithm to detect low piano notes (A0 = 27.5 Hz)
-        // while still maintaining responsive real-time updates
-        bufferSize: 8192,
+        // The analysis window is 8192 samples (~186ms at 44100Hz), enough for
+        // YIN to detect low piano notes (A0 = 27.5 Hz). With the worker, capture
+        // only needs to deliver 2048-sample blocks; otherwise each buffer is
+        // analysed on its own and must hold the full window.
+        bufferSize: _workerRunning ? 2048 : 8192,
       );
       // Keep screen on while recording
       WakelockPlus.enable();
+      // Run the frame ticker for as long as we capture
+      _scrollVelocity = _scrollSpeed;
+      if (!_scrollAnimationController.isAnimating) {
+        _scrollAnimationController.repeat();
+      }
       setState(() {
         _isRecording = true;
         _status = "Listening...";
       });
     } catch (e) {
+      _engine.stopWorker();
+      _workerRunning = false;
+      await _stopIsolateEngine();
       setState(() {
         _status = "Error: $e";
       });
     }
   }
 
+  // Older native library without the worker thread: run detection on a
+  // background isolate so it stays off the UI and raster threads
+  Future<void> _startIsolateEngine() async {
+    try {
+      final isolateEngine = await IsolateAudioEngine.spawn();
+      _isolateEngine = isolateEngine;
+      _isolateResults = isolateEngine.results.listen(
+        (estimate) {
+          final (result, qualityLevel) = estimate;
+          _onPitchResult(result);
+          _onQualityLevel(qualityLevel);
+        },
+        // The isolate died: analyse on this one from the next buffer on
+        onError: (Object e) => _stopIsolateEngine(),
+        onDone: _stopIsolateEngine,
+      );
+    } catch (e) {
+      _isolateEngine = null;
+    }
+  }
+
+  Future<void> _stopIsolateEngine() {
+    final isolateEngine = _isolateEngine;
+    _isolateEngine = null;
+    _isolateResults?.cancel();
+    _isolateResults = null;
+    if (isolateEngine != null) _isolateStopped = isolateEngine.dispose();
+    return _isolateStopped;
+  }
+
+  void _readLatestResult() {
+    final snapshot = _engine.readSharedResult();
+    if (snapshot == null || snapshot.count == _lastResultCount) return;
+    _lastResultCount = snapshot.count;
+    _onPitchResult(snapshot.result);
+    _onQualityLevel(snapshot.qualityLevel);
+
+    final timing = snapshot.timing;
+    if (_showLatency && timing != null) _recordLatency(timing);
+  }
+
+  // Called from the ticker, so the estimate is on screen once this frame
+  // has been built and painted; stamp it then on the engine's clock
+  void _recordLatency(ResultTiming timing) {
+    WidgetsBinding.instance.addPostFrameCallback((_) {
+      final painted = _engine.now;
+      if (painted == null || !mounted) return;
+      _latencyLog.add(LatencyRecord(timing, painted));
+      _latencySummary.value = _latencyLog.summarize();
+    });
+  }
+
+  void _toggleLatencyOverlay() {
+    setState(() {
+      _showLatency = !_showLatency;
+    });
+    _latencyLog.clear();
+    _latencySummary.value = null;
+    Navigator.pop(context);
+  }
+
+  Future<void> _exportLatencyLog() async {
+    final rows = _latencyLog.length;
+    await Clipboard.setData(ClipboardData(text: _latencyLog.toCsv()));
+    if (!mounted) return;
+    ScaffoldMessenger.of(context).showSnackBar(
+      SnackBar(content: Text("Copied $rows latency records as CSV")),
+    );
+  }
+
+  void _onQualityLevel(int level) {
+    if (level != _qualityLevel) {
+      setState(() {
+        _qualityLevel = level;
+      });
+    }
+  }
+
+  void _onPitchResult(PitchResult result) {
+    double pitch = result.smoothedFrequency;
+
+    _lastResultPitched = pitch > 20 && pitch < 5000;
+    if (_lastResultPitched) {
+      _setReadout(
+        _readout.value.copyWith(driftCentsPerSec: result.driftCentsPerSecond),
+      );
+      _calculateNote(pitch);
+    }
+  }
+
   void onError(Object e) {
     print(e);
     setState(() {
@@ -376,67 +524,55 @@ class _TunerScreenState extends State<TunerScreen>
     } catch (e) {
       // Ignore stop errors
     }
+    _engine.stopWorker();
+    _workerRunning = false;
+    await _stopIsolateEngine();
     // Allow screen to turn off again
     WakelockPlus.disable();
-    _standbyTimer?.cancel();
     _resetStandby();
     setState(() {
       _isRecording = false;
       _status = "Paused";
-      _note = "--";
-      _currentPitch = 0.0;
-      _cents = 0.0;
+      _qualityLevel = 0;
     });
+    _setReadout(const TunerReadout());
   }
 
   // ============================================================================
   // Standby Mode - Smooth return to center when no pitch detected
   // ============================================================================
 
-  void _resetStandby() {
-    _standbyTimer?.cancel();
-    _isInStandby = false;
-    _standbyAnimationController.reset();
-    _lastCentsBeforeStandby = 0.0;
+  // Publish a new reading to the readouts that listen for it
+  void _setReadout(TunerReadout readout) {
+    _readout.value = readout;
+    _inTune.value = _isRecording && readout.cents.abs() < 5;
   }
 
-  void _onPitchDetected(double pitch) {
-    // Cancel any pending standby transition
-    _standbyTimer?.cancel();
-
-    // If we were in standby, exit it
+  void _resetStandby() {
     if (_isInStandby) {
-      _isInStandby = false;
-      _standbyAnimationController.reset();
-    }
-
-    // Process the pitch normally
-    _calculateNote(pitch);
-  }
-
-  void _onNoPitchDetected() {
-    // Start standby timer if not already running and not in standby
-    if (_standbyTimer == null || !_standbyTimer!.isActive) {
-      if (!_isInStandby && _note != "--") {
-        _standbyTimer = Timer(_standbyDelay, () {
-          if (mounted && _isRecording) {
-            _enterStandby();
-          }
-        });
-      }
+      _setReadout(_readout.value.copyWith(isInStandby: false));
     }
+    _frame.standbyProgress = 0.0;
+    _lastResultPitched = false;
   }
 
-  void _enterStandby() {
-    if (!mounted) return;
-
-    setState(() {
-      _lastCentsBeforeStandby = _displayedCents;
-      _isInStandby = true;
-    });
+  // Once per frame: while the trail ends in silence, ease the bubble along
+  // the same curve as the trail, entering standby after the hold and
+  // leaving it with the next pitched entry
+  void _updateStandby() {
+    if (!_isRecording) return;
+    final (lastCents, silentEntries) = StandbyCurve.silence(
+      _trail,
+      _trailStart,
+    );
+    final progress = StandbyCurve.progress(silentEntries);
+    _frame.standbyProgress = progress;
+    if (silentEntries > 0) _displayedCents = lastCents * (1 - progress);
 
-    // Start the standby animation for smooth transition
-    _standbyAnimationController.forward();
+    final standby = silentEntries >= StandbyCurve.holdEntries && _note != "--";
+    if (standby != _isInStandby) {
+      _setReadout(_readout.value.copyWith(isInStandby: standby));
+    }
   }
 
   void _calculateNote(double freq) {
@@ -501,15 +637,17 @@ class _TunerScreenState extends State<TunerScreen>
     }
 
     if (mounted) {
-      // Set the target - the continuous lerp will smooth it
-      _targetCents = cents;
-
-      setState(() {
-        _currentPitch = freq;
-        _note = noteName;
-        _octave = octave;
-        _cents = cents;
-      });
+      // Native smoothing already filtered the pitch - show it as is
+      _displayedCents = cents;
+
+      _setReadout(
+        _readout.value.copyWith(
+          pitch: freq,
+          note: noteName,
+          octave: octave,
+          cents: cents,
+        ),
+      );
     }
   }
 
@@ -528,13 +666,21 @@ class _TunerScreenState extends State<TunerScreen>
     return "Flat ↓";
   }
 
+  // Which way the peg is moving, from the native drift estimate
+  String _getDriftText() {
+    if (_driftCentsPerSec.abs() < 1.0) return "steady";
+    String arrow = _driftCentsPerSec > 0 ? "↑" : "↓";
+    return "$arrow ${_driftCentsPerSec.abs().toStringAsFixed(0)} c/s";
+  }
+
   void _setTuningMode(TuningMode mode) {
     setState(() {
       _tuningMode = mode;
       _selectedGuitarString = null;
       _selectedPianoKey = null;
-      _trailPositions.clear();
+      _clearTrail();
     });
+    _updateTrailReference();
 
     // Update the native engine's tuning mode for optimized frequency filtering
     switch (mode) {
@@ -555,8 +701,9 @@ class _TunerScreenState extends State<TunerScreen>
   void _selectGuitarString(GuitarString guitarString) {
     setState(() {
       _selectedGuitarString = guitarString;
-      _trailPositions.clear();
+      _clearTrail();
     });
+    _updateTrailReference();
     if (!_isRecording && _isInitialized) {
       _startCapture();
     }
@@ -565,8 +712,9 @@ class _TunerScreenState extends State<TunerScreen>
   void _selectPianoKey(PianoKey key) {
     setState(() {
       _selectedPianoKey = key;
-      _trailPositions.clear();
+      _clearTrail();
     });
+    _updateTrailReference();
     if (!_isRecording && _isInitialized) {
       _startCapture();
     }
@@ -671,6 +819,16 @@ class _TunerScreenState extends State<TunerScreen>
             onTap: () => _setTuningMode(TuningMode.piano),
           ),
           const Divider(color: Colors.white24),
+          // Only the native worker timestamps its results; still offer the
+          // item while the overlay is on so that it can be turned off
+          if (_engine.now != null && (_workerRunning || _showLatency))
+            _buildDrawerItem(
+              icon: Icons.timer_outlined,
+              title: "Latency overlay",
+              subtitle: "Capture-to-display breakdown",
+              isSelected: _showLatency,
+              onTap: _toggleLatencyOverlay,
+            ),
           const Padding(
             padding: EdgeInsets.all(16),
             child: Text(
@@ -710,6 +868,33 @@ class _TunerScreenState extends State<TunerScreen>
   }
 
   Widget _buildChromaticTunerBody() {
+    return Column(
+      children: [
+        const SizedBox(height: 10),
+        // Detected note display (large), rebuilt once per estimate
+        ValueListenableBuilder<TunerReadout>(
+          valueListenable: _readout,
+          builder: (context, readout, child) => _buildDetectedNote(),
+        ),
+        const SizedBox(height: 10),
+        // Seismograph visualization
+        Expanded(child: _buildSeismograph()),
+        // Tuning status, rebuilt once per estimate
+        RepaintBoundary(
+          child: ValueListenableBuilder<TunerReadout>(
+            valueListenable: _readout,
+            builder: (context, readout, child) => _buildTuningStatusBar(),
+          ),
+        ),
+        const SizedBox(height: 10),
+        // Controls
+        RepaintBoundary(child: _buildControls()),
+        const SizedBox(height: 30),
+      ],
+    );
+  }
+
+  Widget _buildDetectedNote() {
     // In chromatic mode, just show detected note (no "target")
     // Hide the note when in standby mode
     String detectedNote = _isRecording && _note != "--" && !_isInStandby
@@ -718,8 +903,6 @@ class _TunerScreenState extends State<TunerScreen>
 
     return Column(
       children: [
-        const SizedBox(height: 10),
-        // Detected note display (large)
         Text(
           detectedNote,
           style: TextStyle(
@@ -735,15 +918,6 @@ class _TunerScreenState extends State<TunerScreen>
             "${_currentPitch.toStringAsFixed(1)} Hz",
             style: const TextStyle(color: Colors.white38, fontSize: 14),
           ),
-        const SizedBox(height: 10),
-        // Seismograph visualization
-        Expanded(child: _buildSeismograph()),
-        // Tuning status
-        _buildTuningStatusBar(),
-        const SizedBox(height: 10),
-        // Controls
-        _buildControls(),
-        const SizedBox(height: 30),
       ],
     );
   }
@@ -753,7 +927,12 @@ class _TunerScreenState extends State<TunerScreen>
       children: [
         const SizedBox(height: 10),
         // Guitar headstock
-        _buildGuitarHeadstock(),
+        RepaintBoundary(
+          child: ValueListenableBuilder<bool>(
+            valueListenable: _inTune,
+            builder: (context, inTune, child) => _buildGuitarHeadstock(),
+          ),
+        ),
         const SizedBox(height: 10),
         // Target info
         if (_selectedGuitarString != null) ...[
@@ -770,11 +949,16 @@ class _TunerScreenState extends State<TunerScreen>
         const SizedBox(height: 10),
         // Seismograph visualization
         Expanded(child: _buildSeismograph()),
-        // Tuning status
-        _buildTuningStatusBar(),
+        // Tuning status, rebuilt once per estimate
+        RepaintBoundary(
+          child: ValueListenableBuilder<TunerReadout>(
+            valueListenable: _readout,
+            builder: (context, readout, child) => _buildTuningStatusBar(),
+          ),
+        ),
         const SizedBox(height: 10),
         // Controls
-        _buildControls(),
+        RepaintBoundary(child: _buildControls()),
         const SizedBox(height: 20),
       ],
     );
@@ -785,7 +969,12 @@ class _TunerScreenState extends State<TunerScreen>
       children: [
         const SizedBox(height: 10),
         // Piano keyboard
-        _buildPianoKeyboard(),
+        RepaintBoundary(
+          child: ValueListenableBuilder<bool>(
+            valueListenable: _inTune,
+            builder: (context, inTune, child) => _buildPianoKeyboard(),
+          ),
+        ),
         const SizedBox(height: 10),
         // Target info
         if (_selectedPianoKey != null) ...[
@@ -802,11 +991,16 @@ class _TunerScreenState extends State<TunerScreen>
         const SizedBox(height: 10),
         // Seismograph visualization
         Expanded(child: _buildSeismograph()),
-        // Tuning status
-        _buildTuningStatusBar(),
+        // Tuning status, rebuilt once per estimate
+        RepaintBoundary(
+          child: ValueListenableBuilder<TunerReadout>(
+            valueListenable: _readout,
+            builder: (context, readout, child) => _buildTuningStatusBar(),
+          ),
+        ),
         const SizedBox(height: 10),
         // Controls
-        _buildControls(),
+        RepaintBoundary(child: _buildControls()),
         const SizedBox(height: 20),
       ],
     );
@@ -837,8 +1031,7 @@ class _TunerScreenState extends State<TunerScreen>
               Row(
                 children: whiteKeys.map((key) {
                   bool isSelected = _selectedPianoKey == key;
-                  bool isInTune =
-                      isSelected && _isRecording && _cents.abs() < 5;
+                  bool isInTune = isSelected && _inTune.value;
 
                   return GestureDetector(
                     onTap: () => _selectPianoKey(key),
@@ -927,7 +1120,7 @@ class _TunerScreenState extends State<TunerScreen>
                     1;
 
                 bool isSelected = _selectedPianoKey == key;
-                bool isInTune = isSelected && _isRecording && _cents.abs() < 5;
+                bool isInTune = isSelected && _inTune.value;
 
                 return Positioned(
                   left: leftPosition,
@@ -1047,26 +1240,109 @@ class _TunerScreenState extends State<TunerScreen>
         borderRadius: BorderRadius.circular(16),
         border: Border.all(color: Colors.white12),
       ),
-      child: ClipRRect(
-        borderRadius: BorderRadius.circular(16),
-        child: CustomPaint(
-          painter: SeismographPainter(
-            trailPositions: _trailPositions,
-            targetNote: targetNote,
-            isActive: _isRecording,
-            currentCents: _displayedCents,
-            currentNote: _note,
-            currentOctave: _octave,
-            isInStandby: _isInStandby,
-            standbyProgress: _standbyAnimation.value,
-            scrollOffset: _scrollOffset,
+      child: Stack(
+        fit: StackFit.expand,
+        children: [
+          // Repaints every frame on its own layer, without a rebuild
+          RepaintBoundary(
+            child: ClipRRect(
+              borderRadius: BorderRadius.circular(16),
+              child: CustomPaint(
+                painter: SeismographPainter(
+                  trail: _trail,
+                  trailStart: _trailStart,
+                  maxTrailPoints: _maxTrailPoints,
+                  targetNote: targetNote,
+                  isActive: _isRecording,
+                  frame: _frame,
+                  readout: _readout,
+                  background: _seismographBackground,
+                  trailMesh: _trailMesh,
+                ),
+                size: Size.infinite,
+              ),
+            ),
           ),
-          size: Size.infinite,
-        ),
+          if (_showLatency)
+            Positioned(top: 8, left: 8, child: _buildLatencyOverlay()),
+        ],
       ),
     );
   }
 
+  // Average time per segment, from the audio an estimate describes to the
+  // frame that showed it
+  Widget _buildLatencyOverlay() {
+    const labelStyle = TextStyle(color: Colors.white54, fontSize: 11);
+    const valueStyle = TextStyle(
+      color: Colors.white,
+      fontSize: 11,
+      fontFeatures: [ui.FontFeature.tabularFigures()],
+    );
+    return ValueListenableBuilder<LatencySummary?>(
+      valueListenable: _latencySummary,
+      builder: (context, summary, _) {
+        String ms(double seconds) => (seconds * 1000).toStringAsFixed(1);
+        final rows = summary == null
+            ? const <(String, String)>[]
+            : [
+                ("Window + capture", ms(summary.capture)),
+                ("Queue", ms(summary.queue)),
+                ("Analysis", ms(summary.analysis)),
+                ("Display", ms(summary.display)),
+                ("Total", ms(summary.total)),
+                ("Worst total", ms(summary.worstTotal)),
+              ];
+        return Container(
+          padding: const EdgeInsets.fromLTRB(10, 8, 10, 4),
+          decoration: BoxDecoration(
+            color: Colors.black.withOpacity(0.6),
+            borderRadius: BorderRadius.circular(8),
+          ),
+          child: Column(
+            mainAxisSize: MainAxisSize.min,
+            crossAxisAlignment: CrossAxisAlignment.start,
+            children: [
+              Text(
+                summary == null
+                    ? "Latency: waiting for estimates"
+                    : "Latency ms (last ${summary.count})",
+                style: const TextStyle(
+                  color: Colors.greenAccent,
+                  fontSize: 11,
+                  fontWeight: FontWeight.bold,
+                ),
+              ),
+              const SizedBox(height: 4),
+              for (final (label, value) in rows)
+                Row(
+                  mainAxisSize: MainAxisSize.min,
+                  children: [
+                    SizedBox(
+                      width: 104,
+                      child: Text(label, style: labelStyle),
+                    ),
+                    SizedBox(
+                      width: 44,
+                      child: Text(
+                        value,
+                        style: valueStyle,
+                        textAlign: TextAlign.right,
+                      ),
+                    ),
+                  ],
+                ),
+              TextButton(
+                onPressed: summary == null ? null : _exportLatencyLog,
+                child: const Text("Copy log", style: TextStyle(fontSize: 11)),
+              ),
+            ],
+          ),
+        );
+      },
+    );
+  }
+
   Widget _buildTuningStatusBar() {
     String status = _getTuningStatus();
     String centsText = _cents >= 0
@@ -1104,6 +1380,25 @@ class _TunerScreenState extends State<TunerScreen>
             ],
           ),
           Container(width: 1, height: 40, color: Colors.white12),
+          Column(
+            children: [
+              Text(
+                _isRecording && _note != "--" && !_isInStandby
+                    ? _getDriftText()
+                    : "--",
+                style: const TextStyle(
+                  fontSize: 20,
+                  fontWeight: FontWeight.w600,
+                  color: Colors.white70,
+                ),
+              ),
+              const Text(
+                "drift",
+                style: TextStyle(color: Colors.white38, fontSize: 12),
+              ),
+            ],
+          ),
+          Container(width: 1, height: 40, color: Colors.white12),
           Column(
             children: [
               Text(
@@ -1200,7 +1495,7 @@ class _TunerScreenState extends State<TunerScreen>
 
   Widget _buildTunerPeg(GuitarString guitarString) {
     bool isSelected = _selectedGuitarString == guitarString;
-    bool isInTune = isSelected && _isRecording && _cents.abs() < 5;
+    bool isInTune = isSelected && _inTune.value;
 
     return GestureDetector(
       onTap: () => _selectGuitarString(guitarString),
@@ -1264,6 +1559,11 @@ class _TunerScreenState extends State<TunerScreen>
           _status,
           style: const TextStyle(fontSize: 14, color: Colors.white54),
         ),
+        if (_isRecording && _qualityLevel > 0)
+          const Text(
+            "Reduced analysis to keep up with this device",
+            style: TextStyle(fontSize: 11, color: Colors.orangeAccent),
+          ),
         const SizedBox(height: 12),
         GestureDetector(
           onTap: _isRecording ? _stopCapture : _startCapture,
@@ -1294,34 +1594,90 @@ class _TunerScreenState extends State<TunerScreen>
   }
 }
 
-// Seismograph-style painter with animated scrolling background
-class SeismographPainter extends CustomPainter {
-  final List<double> trailPositions; // List of cents values
-  final String targetNote;
-  final bool isActive;
-  final double currentCents;
-  final String currentNote;
-  final int currentOctave;
+// What the readouts show for the latest estimate
+class TunerReadout {
+  final double pitch;
+  final String note;
+  final int octave;
+  final double cents;
+  final double driftCentsPerSec; // Rate of change from the native smoother
   final bool isInStandby;
-  final double standbyProgress;
-  final double scrollOffset; // Continuous scroll offset in pixels
 
-  SeismographPainter({
-    required this.trailPositions,
-    required this.targetNote,
-    required this.isActive,
-    required this.currentCents,
-    required this.currentNote,
-    required this.currentOctave,
+  const TunerReadout({
+    this.pitch = 0.0,
+    this.note = "--",
+    this.octave = 0,
+    this.cents = 0.0,
+    this.driftCentsPerSec = 0.0,
     this.isInStandby = false,
-    this.standbyProgress = 0.0,
-    this.scrollOffset = 0.0,
   });
 
-  @override
-  void paint(Canvas canvas, Size size) {
-    final centerX = size.width / 2;
+  TunerReadout copyWith({
+    double? pitch,
+    String? note,
+    int? octave,
+    double? cents,
+    double? driftCentsPerSec,
+    bool? isInStandby,
+  }) {
+    return TunerReadout(
+      pitch: pitch ?? this.pitch,
+      note: note ?? this.note,
+      octave: octave ?? this.octave,
+      cents: cents ?? this.cents,
+      driftCentsPerSec: driftCentsPerSec ?? this.driftCentsPerSec,
+      isInStandby: isInStandby ?? this.isInStandby,
+    );
+  }
+}
+
+// Seismograph values that change every frame. tick() repaints the painter
+// listening to it; no widget is rebuilt.
+class SeismographFrame extends ChangeNotifier {
+  double scrollOffset = 0.0; // Continuous scroll offset (never resets)
+  double displayedCents = 0.0; // Bubble position, eased during standby
+  double standbyProgress = 0.0;
+
+  void tick() => notifyListeners();
+}
+
+// Static seismograph layers, recorded once per canvas size and target note
+// and replayed every frame: the gradient under the scrolling guide lines,
+// and the center line, in-tune zone and labels above them. Owned by the
+// screen so the recordings outlive the painters that use them.
+class SeismographBackground {
+  Size _size = Size.zero;
+  String _targetNote = "";
+  ui.Picture? under;
+  ui.Picture? over;
+
+  // Re-record the layers if the canvas size or target note changed
+  void prepare(Size size, String targetNote) {
+    if (under != null && size == _size && targetNote == _targetNote) return;
+    dispose();
+    _size = size;
+    _targetNote = targetNote;
+    under = _record(size, _paintUnder);
+    over = _record(
+      size,
+      (canvas, layerSize) => _paintOver(canvas, layerSize, targetNote),
+    );
+  }
 
+  void dispose() {
+    under?.dispose();
+    over?.dispose();
+    under = null;
+    over = null;
+  }
+
+  static ui.Picture _record(Size size, void Function(Canvas, Size) paint) {
+    final recorder = ui.PictureRecorder();
+    paint(Canvas(recorder, Offset.zero & size), size);
+    return recorder.endRecording();
+  }
+
+  static void _paintUnder(Canvas canvas, Size size) {
     // Background gradient
     final bgPaint = Paint()
       ..shader = LinearGradient(
@@ -1330,25 +1686,10 @@ class SeismographPainter extends CustomPainter {
         colors: [const Color(0xFF0D0D1A), const Color(0xFF151528)],
       ).createShader(Rect.fromLTWH(0, 0, size.width, size.height));
     canvas.drawRect(Rect.fromLTWH(0, 0, size.width, size.height), bgPaint);
+  }
 
-    // Draw animated horizontal guide lines (scrolling upward)
-    final guidePaint = Paint()
-      ..color = Colors.white.withOpacity(0.05)
-      ..strokeWidth = 1;
-
-    const int numLines = 8; // More lines for smoother scrolling effect
-    final lineSpacing = size.height / numLines;
-    // Use modulo to wrap scroll offset smoothly
-    final lineScrollOffset = scrollOffset % lineSpacing;
-
-    for (int i = -1; i <= numLines; i++) {
-      // Start from -1 to have lines entering from bottom
-      double y = (i * lineSpacing) - lineScrollOffset;
-      // Wrap around when line goes off the top
-      if (y < 0) y += size.height + lineSpacing;
-      if (y > size.height) continue;
-      canvas.drawLine(Offset(0, y), Offset(size.width, y), guidePaint);
-    }
+  static void _paintOver(Canvas canvas, Size size, String targetNote) {
+    final centerX = size.width / 2;
 
     // Draw vertical center line (perfect pitch line)
     final centerLinePaint = Paint()
@@ -1413,6 +1754,155 @@ class SeismographPainter extends CustomPainter {
       canvas,
       Offset(size.width - sharpPainter.width - 20, size.height - 25),
     );
+  }
+}
+
+// Vertex buffers for the trail's triangle strip (two vertices per point),
+// reused every frame and grown only when more points are shown
+class TrailMesh {
+  Float32List _cents = Float32List(0);
+  Float32List _positions = Float32List(0);
+  Int32List _colors = Int32List(0);
+
+  Float32List cents(int points) {
+    if (_cents.length < points) _cents = Float32List(points);
+    return _cents;
+  }
+
+  Float32List positions(int points) {
+    if (_positions.length < points * 4) _positions = Float32List(points * 4);
+    return _positions;
+  }
+
+  Int32List colors(int points) {
+    if (_colors.length < points * 2) _colors = Int32List(points * 2);
+    return _colors;
+  }
+}
+
+// Standby: silence holds the last offset, then eases it back to center.
+// The trail records silence as NaN, and this one curve places both the
+// bubble and every silent trail entry, timed in trail entries (audio time
+// for the engine's trail).
+class StandbyCurve {
+  static const int holdEntries = kTrailEntriesPerSecond * 4 ~/ 5; // 0.8 s
+  static const int returnEntries = kTrailEntriesPerSecond * 3 ~/ 5; // 0.6 s
+  static const int settledEntries = holdEntries + returnEntries;
+
+  /// How far the offset has returned after [silentEntries] of silence
+  /// (0 while holding, 1 once centered)
+  static double progress(int silentEntries) {
+    final t = (silentEntries - holdEntries) / returnEntries;
+    return Curves.easeOutCubic.transform(t.clamp(0.0, 1.0));
+  }
+
+  /// Silent entries at the head of [trail] since [start] (counted up to
+  /// [settledEntries]) and the offset they followed
+  static (double, int) silence(TrailHistory trail, int start) {
+    final head = trail.head;
+    final limit = min(trail.countSince(start, head), settledEntries);
+    int silent = 0;
+    while (silent < limit && trail.at(head, silent).isNaN) {
+      silent++;
+    }
+    return (silent < limit ? trail.at(head, silent) : 0.0, silent);
+  }
+
+  /// Displayed offsets of the newest [count] entries below [head], newest
+  /// first, with silent entries placed along the curve
+  static void resolve(
+    TrailHistory trail,
+    int start,
+    int head,
+    int count,
+    Float32List out,
+  ) {
+    // Where a silence running into the oldest entry began
+    final limit = min(trail.countSince(start, head), count + settledEntries);
+    int age = count;
+    while (age < limit && trail.at(head, age).isNaN) {
+      age++;
+    }
+    double last = age < limit ? trail.at(head, age) : 0.0;
+    int silent = age - count;
+
+    for (int i = count - 1; i >= 0; i--) {
+      final cents = trail.at(head, i);
+      if (cents.isNaN) {
+        silent++;
+        out[i] = last * (1 - progress(silent));
+      } else {
+        silent = 0;
+        last = cents;
+        out[i] = cents;
+      }
+    }
+  }
+}
+
+// Seismograph-style painter with animated scrolling background
+class SeismographPainter extends CustomPainter {
+  final TrailHistory trail; // Cents values, newest at the head
+  final int trailStart; // Trail head when it was last cleared
+  final int maxTrailPoints;
+  final String targetNote;
+  final bool isActive;
+  final SeismographFrame frame;
+  final ValueListenable<TunerReadout> readout;
+  final SeismographBackground background;
+  final TrailMesh trailMesh;
+
+  static const double _trailHalfWidth = 1.75; // Trail is 3.5px thick
+  static final Paint _trailPaint = Paint();
+  static final Paint _guidePaint = Paint()
+    ..color = Colors.white.withOpacity(0.05)
+    ..strokeWidth = 1;
+
+  SeismographPainter({
+    required this.trail,
+    required this.trailStart,
+    required this.maxTrailPoints,
+    required this.targetNote,
+    required this.isActive,
+    required this.frame,
+    required this.readout,
+    required this.background,
+    required this.trailMesh,
+  }) : super(repaint: Listenable.merge([frame, readout]));
+
+  // Read at paint time, so repaints need no new painter
+  double get currentCents => frame.displayedCents;
+  double get scrollOffset => frame.scrollOffset;
+  double get standbyProgress => frame.standbyProgress;
+  String get currentNote => readout.value.note;
+  int get currentOctave => readout.value.octave;
+  bool get isInStandby => readout.value.isInStandby;
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    final centerX = size.width / 2;
+    background.prepare(size, targetNote);
+
+    // Background gradient (cached)
+    canvas.drawPicture(background.under!);
+
+    // Draw animated horizontal guide lines (scrolling upward)
+    const int numLines = 8; // More lines for smoother scrolling effect
+    final lineSpacing = size.height / numLines;
+    // Use modulo to wrap scroll offset smoothly
+    final lineScrollOffset = scrollOffset % lineSpacing;
+
+    for (int i = -1; i <= numLines; i++) {
+      // Start from -1 to have lines entering from bottom
+      double y = (i * lineSpacing) - lineScrollOffset;
+      // Wrap around when line goes off the top
+      if (y < 0) y += size.height + lineSpacing;
+      if (y > size.height) continue;
+      canvas.drawLine(Offset(0, y), Offset(size.width, y), _guidePaint);
+    }
+
+    // Center line, in-tune zone and labels (cached)
+    canvas.drawPicture(background.over!);
 
     // Always draw the bubble when active (even in standby)
     if (!isActive) return;
@@ -1437,41 +1927,65 @@ class SeismographPainter extends CustomPainter {
     }
 
     // Draw the trail that scrolls upward (seismograph effect)
-    // Trail ALWAYS draws and starts exactly at the bubble
-    if (trailPositions.isNotEmpty) {
-      final trailLength = trailPositions.length;
-      final trailHeight = size.height - 120; // Available height for trail
-
-      final tracePaint = Paint()
-        ..strokeWidth =
-            3.5 // Thicker trail
-        ..style = PaintingStyle.stroke
-        ..strokeCap = StrokeCap.round;
-
-      // Draw trail from bubble upward - segment by segment for gradient effect
-      for (int i = 0; i < trailLength - 1; i++) {
-        final cents1 = trailPositions[i];
-        final cents2 = trailPositions[i + 1];
-
-        // Map cents to x positions
-        final x1 = centerX + (cents1 / 100) * (size.width / 2 - 40);
-        final x2 = centerX + (cents2 / 100) * (size.width / 2 - 40);
-
-        // Y positions: index 0 is at bubble, higher indices go upward
-        final y1 = bubbleY - (i / trailLength) * trailHeight;
-        final y2 = bubbleY - ((i + 1) / trailLength) * trailHeight;
-
-        // Skip if off screen
-        if (y2 < 30) continue;
+    // Trail ALWAYS draws and starts exactly at the bubble. It is one
+    // triangle strip with per-vertex alpha, filled in place from the ring.
+    final trailHead = trail.head;
+    final trailLength = min(
+      trail.countSince(trailStart, trailHead),
+      maxTrailPoints,
+    );
+    final trailHeight = size.height - 120; // Available height for trail
+    if (trailLength > 1 && trailHeight > 0) {
+      final centsScale = (size.width / 2 - 40) / 100;
+      final rgb = bubbleColor.toARGB32() & 0xFFFFFF;
+      final positions = trailMesh.positions(trailLength);
+      final colors = trailMesh.colors(trailLength);
+      final cents = trailMesh.cents(trailLength);
+      StandbyCurve.resolve(trail, trailStart, trailHead, trailLength, cents);
+
+      // Index 0 is at the bubble, higher indices go upward
+      double xAt(int i) => centerX + cents[i] * centsScale;
+      double yAt(int i) => bubbleY - (i / trailLength) * trailHeight;
+
+      double prevX = xAt(0), prevY = yAt(0);
+      double x = prevX, y = prevY;
+      for (int i = 0; i < trailLength; i++) {
+        final last = i == trailLength - 1;
+        final nextX = last ? x : xAt(i + 1);
+        final nextY = last ? y : yAt(i + 1);
+
+        // Offset both edges along the normal of the local direction
+        final dx = nextX - prevX;
+        final dy = nextY - prevY;
+        final scale = _trailHalfWidth / sqrt(dx * dx + dy * dy);
+        final nx = -dy * scale;
+        final ny = dx * scale;
+        positions[i * 4] = x + nx;
+        positions[i * 4 + 1] = y + ny;
+        positions[i * 4 + 2] = x - nx;
+        positions[i * 4 + 3] = y - ny;
 
         // Fade out as trail goes up (older = more transparent)
         final age = i / trailLength;
-        final segmentOpacity = (1.0 - age * 0.85).clamp(0.1, 1.0);
-
-        // Use bubble color with fading opacity
-        tracePaint.color = bubbleColor.withOpacity(segmentOpacity * 0.8);
-        canvas.drawLine(Offset(x1, y1), Offset(x2, y2), tracePaint);
+        final opacity = (1.0 - age * 0.85).clamp(0.1, 1.0) * 0.8;
+        final argb = ((opacity * 255).round() << 24) | rgb;
+        colors[i * 2] = argb;
+        colors[i * 2 + 1] = argb;
+
+        prevX = x;
+        prevY = y;
+        x = nextX;
+        y = nextY;
       }
+
+      // Vertex colors only (BlendMode.dst ignores the paint's color)
+      final vertices = ui.Vertices.raw(
+        ui.VertexMode.triangleStrip,
+        Float32List.sublistView(positions, 0, trailLength * 4),
+        colors: Int32List.sublistView(colors, 0, trailLength * 2),
+      );
+      canvas.drawVertices(vertices, BlendMode.dst, _trailPaint);
+      vertices.dispose();
     }
 
     // Draw the current position circle (floating note bubble)
@@ -1601,8 +2115,18 @@ class SeismographPainter extends CustomPainter {
     }
   }
 
+  // Per-frame changes arrive through the repaint listenable; a rebuild
+  // only needs a repaint when the configuration changed
   @override
   bool shouldRepaint(SeismographPainter oldDelegate) {
-    return true; // Always repaint for smooth animation
+    return oldDelegate.trail != trail ||
+        oldDelegate.trailStart != trailStart ||
+        oldDelegate.maxTrailPoints != maxTrailPoints ||
+        oldDelegate.targetNote != targetNote ||
+        oldDelegate.isActive != isActive ||
+        oldDelegate.frame != frame ||
+        oldDelegate.readout != readout ||
+        oldDelegate.background != background ||
+        oldDelegate.trailMesh != trailMesh;
   }
 }